@@ -38,34 +38,132 @@ def crc32c_update(c, d):
 # Value of crc(0, a+struct.pack('I', crc(0, a))) for any string a
 CRC_OK_REM = crc32c_update(0, b'\x00'*4)
 
-def build_c(f):
-  print('''/*
- * Copyright 2017-2018 Unit Circle Inc.
- *
- * Licensed under the Apache License, Version 2.0 (the "License");
- * you may not use this file except in compliance with the License.
- * You may obtain a copy of the License at
- *
- *     http://www.apache.org/licenses/LICENSE-2.0
- *
- * Unless required by applicable law or agreed to in writing, software
- * distributed under the License is distributed on an "AS IS" BASIS,
- * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
- * See the License for the specific language governing permissions and
- * limitations under the License.
- */
+HEADER = '''// \u00a9 2025 Unit Circle Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Generated by src-python/crc32c.py - do not edit.
+
 #pragma once
+'''
+
+def print_tab(f, t):
+  print('  {', file=f)
+  for i in range(0, len(t), 4):
+    print('   ' + ''.join(' 0x%08x,' % v for v in t[i:i+4]), file=f)
+  print('  },', file=f)
+
+def x2n():
+  # x^(2^k) mod P for k in 0..31, for crc32c_combine
+  t = [0x40000000]  # x^1
+  for _ in range(31):
+    v = t[-1]
+    # square - multiply v by itself mod P
+    p, a, b = 0, v, v
+    m = 0x80000000
+    while m:
+      if a & m:
+        p ^= b
+      b = (b >> 1) ^ (CRC32C_POLY if b & 1 else 0)
+      m >>= 1
+    t.append(p)
+  return t
 
-static const uint32_t crc32c_tab[256] = {
- ''', file=f, end='')
-  for i, v in enumerate(tab):
-    print(" 0x%08x," % v, file=f, end='')
-    if (i + 1) % 4 == 0:
-      print(file=f)
-      if (i + 1) < len(tab):
-        print(' ', file=f, end='')
+def build_c(f):
+  print(HEADER, file=f)
+  print('static const uint32_t crc32c_tab[256] = {', file=f)
+  for i in range(0, len(tab), 4):
+    print(' ' + ''.join(' 0x%08x,' % v for v in tab[i:i+4]), file=f)
   print('};', file=f)
   print('#define CRC32C_OK_REM (0x%08x)' % CRC_OK_REM, file=f)
+  print(file=f)
+  print('// x^(2^k) mod P', file=f)
+  print('static const uint32_t crc32c_x2n[32] = {', file=f)
+  t = x2n()
+  for i in range(0, len(t), 4):
+    print(' ' + ''.join(' 0x%08x,' % v for v in t[i:i+4]), file=f)
+  print('};', file=f)
+
+def crc32c_zeros(c, n):
+  # Raw (no pre/post inversion) crc register after n 0x00 bytes
+  for _ in range(n):
+    c = (c >> 8) ^ tab[c & 0xff]
+  return c
+
+def build_shift(n):
+  # Tables to shift a raw crc register over n 0x00 bytes, one per byte of
+  # the register - the operator is linear so build from single bits.
+  bits = [crc32c_zeros(1 << b, n) for b in range(32)]
+  def op(v):
+    r = 0
+    for b in range(32):
+      if v & (1 << b):
+        r ^= bits[b]
+    return r
+  return [[op(v << (8 * k)) for v in range(256)] for k in range(4)]
+
+# Shift tables for the hardware (SSE4.2) CRC32C - see crc32c.c
+HW_LONG = 8192
+HW_SHORT = 256
+
+def xpow(n):
+  # x^n mod P, in the reflected (register) bit order
+  v = 0x80000000
+  for _ in range(n):
+    v = (v >> 1) ^ (CRC32C_POLY if v & 1 else 0)
+  return v
+
+def build_fold():
+  # PCLMULQDQ constants to fold 16 bytes forward by d bytes - low 64 bits
+  # multiply the first 8 bytes (x^(8d+64)), high the last 8 (x^(8d)).
+  # The extra x^-32 and <<1 align the product with the 128 bit lane.
+  return [(xpow(8 * d + 32) << 1, xpow(8 * d - 32) << 1) for d in (16, 32, 48, 64)]
+
+def build_hw_c(f):
+  print(HEADER, file=f)
+  print('#define CRC32C_LONG  (%d)' % HW_LONG, file=f)
+  print('#define CRC32C_SHORT (%d)' % HW_SHORT, file=f)
+  for name, n in (('long', HW_LONG), ('short', HW_SHORT)):
+    print(file=f)
+    print('static const uint32_t crc32c_%s[4][256] = {' % name, file=f)
+    for t in build_shift(n):
+      print_tab(f, t)
+    print('};', file=f)
+  print(file=f)
+  print('// Fold by 16, 32, 48 and 64 bytes', file=f)
+  print('static const uint64_t crc32c_fold[4][2] = {', file=f)
+  for k1, k2 in build_fold():
+    print('  { 0x%016x, 0x%016x },' % (k1, k2), file=f)
+  print('};', file=f)
+
+# Tables for slicing-by-8/16 - row k is the crc of a byte followed by k 0x00s.
+# Row 0 is crc32c_tab so is not repeated.
+def build_slice():
+  rows = [tab]
+  for _ in range(15):
+    rows.append([(v >> 8) ^ tab[v & 0xff] for v in rows[-1]])
+  return rows[1:]
+
+def build_slice_c(f):
+  print(HEADER, file=f)
+  print('// Rows 1.. of the tables, row 0 is crc32c_tab', file=f)
+  print('static const uint32_t crc32c_slice[CRC32C_SLICE - 1][256] = {', file=f)
+  for k, t in enumerate(build_slice(), 1):
+    if k == 8:
+      print('#if CRC32C_SLICE > 8', file=f)
+    print_tab(f, t)
+  print('#endif', file=f)
+  print('};', file=f)
 
 def test_crc32c():
   print(hex(crc32c_update(0, b'hello there')))
@@ -82,5 +180,10 @@ if __name__ == '__main__':
   #with open('../src-uc/crc32c_tab.h', 'wt') as f:
   import sys
   with sys.stdout as f:
-    build_c(f)
+    if sys.argv[1:] == ['hw']:
+      build_hw_c(f)
+    elif sys.argv[1:] == ['slice']:
+      build_slice_c(f)
+    else:
+      build_c(f)
 
@@ -13,33 +13,86 @@
 // limitations under the License.
 
 #include "cb.h"
+#include <assert.h>
 #include <stdint.h>
 #include <string.h>
 
+// Each index has one writer.  The owner reads its own index relaxed, the
+// other side reads it with acquire to see the data (or free space) the
+// owner published with release.
+#define OWN(x_)         atomic_load_explicit(&(x_), memory_order_relaxed)
+#define OTHER(x_)       atomic_load_explicit(&(x_), memory_order_acquire)
+#define PUBLISH(x_, v_) atomic_store_explicit(&(x_), (v_), memory_order_release)
+
+#if defined(CB_POW2)
+// n is a power of 2 and the indexes run freely, wrapping at SIZE_MAX -
+// the offset in b is the low bits.  All n bytes can be used.
+#define CB_SLACK 0
+
+static inline size_t off(const cb_t* cb, size_t i) {
+  return i & (cb->n - 1);
+}
+
+static inline size_t used(const cb_t* cb, size_t r, size_t w) {
+  (void) cb;
+  return w - r;
+}
+
+static inline size_t advance(const cb_t* cb, size_t i, size_t n) {
+  (void) cb;
+  return i + n;
+}
+#else
+// Indexes are offsets in b, one byte is left unused so that full and
+// empty can be told apart.
+#define CB_SLACK 1
+
+static inline size_t off(const cb_t* cb, size_t i) {
+  (void) cb;
+  return i;
+}
+
+static inline size_t used(const cb_t* cb, size_t r, size_t w) {
+  return r <= w ? w - r : cb->n - r + w;
+}
+
+static inline size_t advance(const cb_t* cb, size_t i, size_t n) {
+  i += n;
+  return i >= cb->n ? i - cb->n : i;
+}
+#endif
+
+static inline size_t min(size_t a, size_t b) {
+  return a < b ? a : b;
+}
+
 void cb_init(cb_t* cb, void* b, size_t n) {
+#if defined(CB_POW2)
+  assert((n != 0) && ((n & (n - 1)) == 0));
+#endif
   cb->b = b;
   cb->n = n;
-  cb->read = 0;
-  cb->write = 0;
+  cb->span = n;
+  atomic_store_explicit(&cb->read, 0, memory_order_relaxed);
+  atomic_store_explicit(&cb->write, 0, memory_order_relaxed);
 }
 
 void cb_reset(cb_t* cb) {
-  cb->read = 0;
-  cb->write = 0;
+  atomic_store_explicit(&cb->read, 0, memory_order_relaxed);
+  atomic_store_explicit(&cb->write, 0, memory_order_relaxed);
 }
 
 size_t cb_read_avail(const cb_t* cb) {
-  return cb->read <= cb->write ? cb->write - cb->read : cb->n - cb->read + cb->write;
+  return used(cb, OWN(cb->read), OTHER(cb->write));
 }
 
 void cb_read(cb_t* cb, void* b, size_t n) {
-  size_t n1 = cb->n - cb->read; // max read before wrapping buffer
+  size_t r = OWN(cb->read);
+  size_t n1 = cb->span - off(cb, r); // max read before wrapping buffer
   if (n1 > n) n1 = n;
-  memmove(b, (uint8_t*) cb->b + cb->read, n1);
+  memmove(b, (uint8_t*) cb->b + off(cb, r), n1);
   if (n1 < n) memmove((uint8_t*) b + n1, cb->b, n - n1);
-  n1 = cb->read + n;
-  if (n1 >= cb->n) n1 -= cb->n;
-  cb->read = n1;
+  PUBLISH(cb->read, advance(cb, r, n));
 }
 
 size_t cb_peek_avail(const cb_t *cb) {
@@ -47,21 +100,20 @@ size_t cb_peek_avail(const cb_t *cb) {
   // The result might be 2 calls to peek/skip to read everything that is queued.
   // Assumes that next layer up will convert input to a linear buffer
   // for the largest "message" size.
-  return cb->read <= cb->write ? cb->write - cb->read : cb->n - cb->read;
+  size_t r = OWN(cb->read);
+  return min(used(cb, r, OTHER(cb->write)), cb->span - off(cb, r));
 }
 
 const void* cb_peek(const cb_t* cb) {
-  return (uint8_t*) cb->b + cb->read;
+  return (uint8_t*) cb->b + off(cb, OWN(cb->read));
 }
 
 void cb_skip(cb_t* cb, size_t n) {
-  size_t r = cb->read + n;
-  if (r >= cb->n) r -= cb->n;
-  cb->read = r;
+  PUBLISH(cb->read, advance(cb, OWN(cb->read), n));
 }
 
 size_t cb_write_avail(const cb_t* cb) {
-  return (cb->read > cb->write ? cb->read - cb->write : cb->n - cb->write + cb->read) - 1;
+  return cb->n - CB_SLACK - used(cb, OTHER(cb->read), OWN(cb->write));
 }
 
 void cb_write(cb_t* cb, const void* in, size_t n) {
@@ -71,28 +123,48 @@ void cb_write(cb_t* cb, const void* in, size_t n) {
   //   caller will need to ensure consumer (reader) can't run during this time.
   // - delay writing until enough space.
   // - drop data.
-  size_t n1 = cb->n - cb->write; // max write before wrapping buffer
+  size_t w = OWN(cb->write);
+  size_t n1 = cb->span - off(cb, w); // max write before wrapping buffer
   if (n1 > n) n1 = n;
-  memmove((uint8_t*) cb->b + cb->write, in, n1);
+  memmove((uint8_t*) cb->b + off(cb, w), in, n1);
   if (n > n1) memmove(cb->b, (const uint8_t*) in + n1, (n - n1));
-  n1 = cb->write + n;
-  if (n1 >= cb->n) n1 -= cb->n;
-  cb->write = n1;
+  PUBLISH(cb->write, advance(cb, w, n));
 }
 
 size_t cb_space_avail(const cb_t *cb) {
-  return (cb->read > cb->write ?
-      cb->read - cb->write :
-      cb->n - cb->write + (cb->read > 0 ? 1 : 0)) - 1;
+  // What can be written linearly via cb_space - as for cb_peek_avail
+  size_t w = OWN(cb->write);
+  size_t avail = cb->n - CB_SLACK - used(cb, OTHER(cb->read), w);
+  return min(avail, cb->span - off(cb, w));
 }
 
 const void* cb_space(const cb_t* cb) {
-  return (uint8_t*) cb->b + cb->write;
+  return (uint8_t*) cb->b + off(cb, OWN(cb->write));
 }
 
 void cb_commit(cb_t* cb, size_t n) {
-  size_t w = cb->write + n;
-  if (w >= cb->n) w -= cb->n;
-  cb->write = w;
+  PUBLISH(cb->write, advance(cb, OWN(cb->write), n));
 }
 
+#if defined(CB_HAS_IOVEC)
+// Split n bytes at index i into the run to the end of the buffer and the
+// rest from the start
+static size_t split(const cb_t* cb, size_t i, size_t n, struct iovec iov[2]) {
+  size_t n1 = min(n, cb->span - off(cb, i));
+  iov[0].iov_base = (uint8_t*) cb->b + off(cb, i);
+  iov[0].iov_len = n1;
+  iov[1].iov_base = cb->b;
+  iov[1].iov_len = n - n1;
+  return n;
+}
+
+size_t cb_peek_iov(const cb_t* cb, struct iovec iov[2]) {
+  size_t r = OWN(cb->read);
+  return split(cb, r, used(cb, r, OTHER(cb->write)), iov);
+}
+
+size_t cb_space_iov(const cb_t* cb, struct iovec iov[2]) {
+  size_t w = OWN(cb->write);
+  return split(cb, w, cb->n - CB_SLACK - used(cb, OTHER(cb->read), w), iov);
+}
+#endif
@@ -14,22 +14,63 @@
 
 #pragma once
 
+#include <stdint.h>
 #include <stdlib.h>
+#if defined(__has_include)
+#if __has_include(<sys/uio.h>)
+#include <sys/uio.h>
+#define CB_HAS_IOVEC 1
+#endif
+#endif
+
+// Lock free single producer/single consumer.  read is only written by the
+// consumer and write only by the producer, each published with release
+// and read with acquire by the other side, so data written before
+// cb_write/cb_commit is visible to the consumer once it sees the bytes as
+// available (and likewise for space freed by cb_read/cb_skip).
+// The header is also usable from C++, via std::atomic.
+#ifdef __cplusplus
+#include <atomic>
+#define CB_ATOMIC(t_) std::atomic<t_>
+#else
+#include <stdatomic.h>
+#define CB_ATOMIC(t_) _Atomic t_
+#endif
+
+// read and write are kept on separate cache lines so the producer and
+// consumer do not contend for one line.  Set CB_CACHE_LINE to the line
+// size of the target, or 0 to not pad (e.g. MCUs without a data cache).
+// Must be the same for every file using cb_t.
+#ifndef CB_CACHE_LINE
+#if defined(CONFIG_UCCOMM_CB_CACHE_LINE)
+#define CB_CACHE_LINE CONFIG_UCCOMM_CB_CACHE_LINE
+#else
+#define CB_CACHE_LINE 64
+#endif
+#endif
 
 #ifdef __cplusplus
+#define CB_ALIGN alignas(CB_CACHE_LINE)
 extern "C" {
+#else
+#define CB_ALIGN _Alignas(CB_CACHE_LINE)
 #endif
 
+// Built with CB_POW2 (Kconfig UCCOMM_CB_POW2) the size must be a power of 2,
+// the indexes run freely and are masked, and all n bytes can be used.
+// Otherwise any size works but one byte is never used.
 typedef struct {
   void*  b;
   size_t n;
-  size_t read;
-  size_t write;
+  size_t span;  // bytes mapped at b - 2n if mirrored (see cb_mirror.h)
+  CB_ALIGN CB_ATOMIC(size_t) read;
+  CB_ALIGN CB_ATOMIC(size_t) write;
 } cb_t;
 
-#define CB_INIT(b_) { .b = b_, .n = sizeof(b_), .read = 0, .write = 0 }
+#define CB_INIT(b_) { .b = b_, .n = sizeof(b_), .span = sizeof(b_), .read = 0, .write = 0 }
 
 void cb_init(cb_t* cb, void* b, size_t n);
+// Not thread safe - neither side may be using the buffer.
 void cb_reset(cb_t* cb);
 
 size_t cb_read_avail(const cb_t *cb);
@@ -46,6 +87,14 @@ size_t cb_space_avail(const cb_t *cb);
 const void* cb_space(const cb_t* cb);
 void cb_commit(cb_t* cb, size_t n);
 
+#if defined(CB_HAS_IOVEC)
+// Everything queued (free) as up to two runs - iov[1] is the part that
+// wrapped to the start of b, with iov_len 0 if none.  Returns the total,
+// which can be passed to cb_skip (cb_commit), or any part of it.
+size_t cb_peek_iov(const cb_t* cb, struct iovec iov[2]);
+size_t cb_space_iov(const cb_t* cb, struct iovec iov[2]);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,28 @@
+// © 2025 Unit Circle Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cb_crc32c.h"
+#include "crc32c.h"
+
+uint32_t cb_read_crc32c(cb_t* cb, void* b, size_t n, uint32_t crc) {
+  size_t n1 = cb_peek_avail(cb); // max read before wrapping buffer
+  if (n1 > n) n1 = n;
+  crc = crc32c_copy(b, cb_peek(cb), n1, crc);
+  cb_skip(cb, n1);
+  if (n1 < n) {
+    crc = crc32c_copy((uint8_t*) b + n1, cb_peek(cb), n - n1, crc);
+    cb_skip(cb, n - n1);
+  }
+  return crc;
+}
@@ -0,0 +1,31 @@
+// © 2025 Unit Circle Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+
+#include "cb.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// As cb_read, also returning crc updated with the bytes read - both parts
+// of a wrapped read are done with crc32c_copy.
+uint32_t cb_read_crc32c(cb_t* cb, void* b, size_t n, uint32_t crc);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,36 @@
+// © 2025 Unit Circle Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// cb_t <-> file descriptor transfers - POSIX only.  The free space (or
+// queued data) from cb_space_iov (cb_peek_iov) is passed to readv (writev)
+// so the kernel copies straight into (out of) the ring in one call.
+
+#include <sys/uio.h>
+#include "cb_fd.h"
+
+ssize_t cb_fill_from_fd(cb_t* cb, int fd) {
+  struct iovec iov[2];
+  cb_space_iov(cb, iov);
+  ssize_t n = readv(fd, iov, iov[1].iov_len > 0 ? 2 : 1);
+  if (n > 0) cb_commit(cb, (size_t) n);
+  return n;
+}
+
+ssize_t cb_drain_to_fd(cb_t* cb, int fd) {
+  struct iovec iov[2];
+  cb_peek_iov(cb, iov);
+  ssize_t n = writev(fd, iov, iov[1].iov_len > 0 ? 2 : 1);
+  if (n > 0) cb_skip(cb, (size_t) n);
+  return n;
+}
@@ -0,0 +1,34 @@
+// © 2025 Unit Circle Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <sys/types.h>
+
+#include "cb.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// POSIX only (cb_fd.c) - one readv into all the free space / one writev of
+// all the queued data, straight between the kernel and the ring.  Return as
+// read/write: bytes moved, 0 at end of file, or -1 with errno set.  Call
+// fill only with space free (cb_write_avail > 0), else it returns 0.
+ssize_t cb_fill_from_fd(cb_t* cb, int fd);
+ssize_t cb_drain_to_fd(cb_t* cb, int fd);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,59 @@
+// © 2025 Unit Circle Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Mirrored cb_t - the buffer's pages are mapped twice, one after the other,
+// so b[i] and b[i + n] are the same byte and any span of up to n bytes
+// starting in the first mapping is contiguous.  Linux only (memfd_create).
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "cb_mirror.h"
+
+int cb_mirror_init(cb_t* cb, size_t n) {
+  size_t page = (size_t) sysconf(_SC_PAGESIZE);
+  n = (n + page - 1) & ~(page - 1);
+  if (n == 0) n = page;
+
+  int fd = memfd_create("cb_mirror", MFD_CLOEXEC);
+  if (fd < 0) return -1;
+
+  // Reserve 2n of address space, then map the file over both halves
+  uint8_t* b = MAP_FAILED;
+  if (ftruncate(fd, (off_t) n) == 0) {
+    b = mmap(NULL, 2 * n, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  }
+  if ((b != MAP_FAILED) &&
+      ((mmap(b, n, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) ||
+       (mmap(b + n, n, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED))) {
+    munmap(b, 2 * n);
+    b = MAP_FAILED;
+  }
+  int e = errno;
+  close(fd);  // the mappings keep the memory
+  errno = e;
+  if (b == MAP_FAILED) return -1;
+
+  cb_init(cb, b, n);
+  cb->span = 2 * n;
+  return 0;
+}
+
+void cb_mirror_free(cb_t* cb) {
+  munmap(cb->b, cb->span);
+  cb->b = NULL;
+  cb->n = 0;
+  cb->span = 0;
+}
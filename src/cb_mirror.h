@@ -0,0 +1,34 @@
+// © 2025 Unit Circle Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stddef.h>
+
+#include "cb.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Linux only (cb_mirror.c) - maps a buffer of n bytes (rounded up to a
+// page) twice, back to back, so that everything readable via cb_peek or
+// writable via cb_space is contiguous, even across the wrap.  Returns 0,
+// or -1 with errno set.  With CB_POW2 n must be a power of 2.
+int cb_mirror_init(cb_t* cb, size_t n);
+void cb_mirror_free(cb_t* cb);
+
+#ifdef __cplusplus
+}
+#endif
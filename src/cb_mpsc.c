@@ -0,0 +1,98 @@
+// © 2025 Unit Circle Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdbool.h>
+#include <string.h>
+#include "cb_mpsc.h"
+
+// Record header - size of the whole record (header, data and padding) set
+// by the producer when reserving, and state published when committing.
+typedef struct {
+  uint32_t size;
+  CB_ATOMIC(uint32_t) state;
+} hdr_t;
+
+#define COMMITTED 0x80000000u
+#define SKIP      0x40000000u  // end of buffer is unused, continue at start
+
+// Multiple of the header size, so a skip marker always fits at the end
+static inline size_t rec_size(size_t n) {
+  return sizeof(hdr_t) + ((n + sizeof(hdr_t) - 1) & ~(sizeof(hdr_t) - 1));
+}
+
+static inline hdr_t* hdr_at(const cb_mpsc_t* q, size_t i) {
+  return (hdr_t*) (q->b + (i & (q->n - 1)));
+}
+
+void cb_mpsc_init(cb_mpsc_t* q, void* b, size_t n) {
+  q->b = b;
+  q->n = n;
+  memset(b, 0, n);
+  atomic_store_explicit(&q->head, 0, memory_order_relaxed);
+  atomic_store_explicit(&q->tail, 0, memory_order_relaxed);
+}
+
+void* cb_mpsc_reserve(cb_mpsc_t* q, size_t n) {
+  size_t need = rec_size(n);
+  size_t h = atomic_load_explicit(&q->head, memory_order_relaxed);
+  size_t skip;
+  do {
+    // Acquire on tail - the consumer has zeroed what it released
+    size_t t = atomic_load_explicit(&q->tail, memory_order_acquire);
+    size_t to_end = q->n - (h & (q->n - 1));
+    skip = need > to_end ? to_end : 0;
+    if (h + skip + need - t > q->n) return NULL;
+  } while (!atomic_compare_exchange_weak_explicit(&q->head, &h, h + skip + need,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed));
+  if (skip > 0) {
+    hdr_t* s = hdr_at(q, h);
+    s->size = (uint32_t) skip;
+    atomic_store_explicit(&s->state, SKIP, memory_order_release);
+  }
+  hdr_t* r = hdr_at(q, h + skip);
+  r->size = (uint32_t) need;
+  return r + 1;
+}
+
+void cb_mpsc_commit(cb_mpsc_t* q, void* p, size_t n) {
+  (void) q;
+  hdr_t* r = (hdr_t*) p - 1;
+  atomic_store_explicit(&r->state, COMMITTED | (uint32_t) n, memory_order_release);
+}
+
+const void* cb_mpsc_peek(cb_mpsc_t* q, size_t* n) {
+  while (true) {
+    size_t t = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    hdr_t* r = hdr_at(q, t);
+    uint32_t state = atomic_load_explicit(&r->state, memory_order_acquire);
+    if (state == 0) return NULL;  // empty, or next record not committed yet
+    if (state & COMMITTED) {
+      *n = state & ~COMMITTED;
+      return r + 1;
+    }
+    cb_mpsc_release(q);  // skip marker
+  }
+}
+
+void cb_mpsc_release(cb_mpsc_t* q) {
+  size_t t = atomic_load_explicit(&q->tail, memory_order_relaxed);
+  hdr_t* r = hdr_at(q, t);
+  size_t size = r->size;
+  // The state word is atomic so is cleared as such.  The rest is plain
+  // memory until a later header lands on it, after the tail store below.
+  atomic_store_explicit(&r->state, 0, memory_order_relaxed);
+  memset(r + 1, 0, size - sizeof(*r));
+  atomic_store_explicit(&q->tail, t + size, memory_order_release);
+}
@@ -0,0 +1,64 @@
+// © 2025 Unit Circle Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cb.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Multi producer/single consumer record queue - lock free.
+// Producers claim space with a compare and swap on head, fill it in place
+// and commit it, in any order.  The consumer sees records in the order
+// they were reserved, each only once it is committed (so a slow producer
+// holds up the records reserved after it).
+// Records have an 8 byte header and are never split by the wrap.  The
+// consumer zeroes records as it releases them, so free space always reads
+// as "not committed".
+//
+// Producer (any thread):
+//   uint8_t* p = cb_mpsc_reserve(&q, max_n);  // NULL if full
+//   ... fill p[0..n) ...
+//   cb_mpsc_commit(&q, p, n);                 // n <= max_n
+// Consumer (one thread):
+//   size_t n;
+//   const uint8_t* p = cb_mpsc_peek(&q, &n);  // NULL if none ready
+//   ... use p[0..n) ...
+//   cb_mpsc_release(&q);
+
+typedef struct {
+  uint8_t* b;
+  size_t   n;
+  CB_ALIGN CB_ATOMIC(size_t) head; // reserved up to, free running
+  CB_ALIGN CB_ATOMIC(size_t) tail; // released up to, free running
+} cb_mpsc_t;
+
+// n must be a power of 2 and b 4 byte aligned.  A record takes n + 8
+// bytes, rounded up to a multiple of 8.
+void cb_mpsc_init(cb_mpsc_t* q, void* b, size_t n);
+
+void* cb_mpsc_reserve(cb_mpsc_t* q, size_t n);
+void cb_mpsc_commit(cb_mpsc_t* q, void* p, size_t n);
+
+const void* cb_mpsc_peek(cb_mpsc_t* q, size_t* n);
+void cb_mpsc_release(cb_mpsc_t* q);
+
+#ifdef __cplusplus
+}
+#endif
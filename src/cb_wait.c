@@ -0,0 +1,108 @@
+// © 2025 Unit Circle Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Blocking waits for cb_t on Linux futexes.
+//
+// The waiter stores its threshold then checks the cb, the notifier
+// publishes its index then checks for a threshold - with a full fence on
+// both sides one of them always sees the other, so a wake up is never
+// lost.  The notifier that sees the threshold met clears it, so only one
+// of several notifies makes the syscall.
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <linux/futex.h>
+#include <stdbool.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include "cb_wait.h"
+
+static uint64_t now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000u + (uint64_t) ts.tv_nsec / 1000000u;
+}
+
+static void futex_wait(CB_ATOMIC(uint32_t)* word, uint32_t val, int timeout_ms) {
+  struct timespec ts = { timeout_ms / 1000, (timeout_ms % 1000) * 1000000L };
+  syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, val, timeout_ms < 0 ? NULL : &ts, NULL, 0);
+}
+
+static void futex_wake(CB_ATOMIC(uint32_t)* word) {
+  syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+static int wait_for(cb_wait_t* w, CB_ATOMIC(size_t)* want, CB_ATOMIC(uint32_t)* seq,
+                    size_t (*avail)(const cb_t*), size_t min, int timeout_ms) {
+  uint64_t end = now_ms() + (uint64_t) timeout_ms;
+  while (true) {
+    uint32_t s = atomic_load_explicit(seq, memory_order_relaxed);
+    atomic_store_explicit(want, min, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    if (avail(w->cb) >= min) {
+      atomic_store_explicit(want, 0, memory_order_relaxed);
+      return 0;
+    }
+    int left = -1;
+    if (timeout_ms >= 0) {
+      uint64_t t = now_ms();
+      if (t >= end) {
+        atomic_store_explicit(want, 0, memory_order_relaxed);
+        errno = ETIMEDOUT;
+        return -1;
+      }
+      left = (int) (end - t);
+    }
+    // Returns at once if seq has moved on since it was read
+    futex_wait(seq, s, left);
+  }
+}
+
+static void notify(cb_wait_t* w, CB_ATOMIC(size_t)* want, CB_ATOMIC(uint32_t)* seq,
+                   size_t (*avail)(const cb_t*)) {
+  atomic_thread_fence(memory_order_seq_cst);
+  size_t min = atomic_load_explicit(want, memory_order_relaxed);
+  if ((min == 0) || (avail(w->cb) < min)) return;
+  if (!atomic_compare_exchange_strong_explicit(want, &min, 0, memory_order_relaxed,
+                                               memory_order_relaxed)) {
+    return;  // another notify got there first, or the waiter gave up
+  }
+  atomic_fetch_add_explicit(seq, 1, memory_order_release);
+  futex_wake(seq);
+}
+
+void cb_wait_init(cb_wait_t* w, cb_t* cb) {
+  w->cb = cb;
+  atomic_store_explicit(&w->rmin, 0, memory_order_relaxed);
+  atomic_store_explicit(&w->wmin, 0, memory_order_relaxed);
+  atomic_store_explicit(&w->rseq, 0, memory_order_relaxed);
+  atomic_store_explicit(&w->wseq, 0, memory_order_relaxed);
+}
+
+int cb_wait_readable(cb_wait_t* w, size_t min, int timeout_ms) {
+  return wait_for(w, &w->rmin, &w->rseq, cb_read_avail, min, timeout_ms);
+}
+
+int cb_wait_writable(cb_wait_t* w, size_t min, int timeout_ms) {
+  return wait_for(w, &w->wmin, &w->wseq, cb_write_avail, min, timeout_ms);
+}
+
+void cb_wait_notify_readable(cb_wait_t* w) {
+  notify(w, &w->rmin, &w->rseq, cb_read_avail);
+}
+
+void cb_wait_notify_writable(cb_wait_t* w) {
+  notify(w, &w->wmin, &w->wseq, cb_write_avail);
+}
@@ -0,0 +1,60 @@
+// © 2025 Unit Circle Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cb.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Blocking waits on a cb_t - Linux only (futex), in cb_wait.c.
+// The consumer sleeps in cb_wait_readable until at least min bytes are
+// queued, the producer in cb_wait_writable until min bytes are free.
+// The other side calls the matching notify after each cb_write/cb_commit
+// (or cb_read/cb_skip).  Notify is a couple of atomic loads unless a
+// waiter's threshold has just been reached, so the wake up syscall is paid
+// once per batch - not per write.
+//
+// Consumer:
+//   if (cb_wait_readable(&w, hdr_n, 100) == 0) { ... cb_read ...; cb_wait_notify_writable(&w); }
+// Producer:
+//   cb_write(&cb, in, n);
+//   cb_wait_notify_readable(&w);
+
+typedef struct {
+  cb_t* cb;
+  CB_ATOMIC(size_t)   rmin;  // bytes the consumer is waiting for, 0 if none
+  CB_ATOMIC(size_t)   wmin;  // free bytes the producer is waiting for
+  CB_ATOMIC(uint32_t) rseq;  // futex words - bumped on each wake up
+  CB_ATOMIC(uint32_t) wseq;
+} cb_wait_t;
+
+void cb_wait_init(cb_wait_t* w, cb_t* cb);
+
+// timeout_ms < 0 waits for ever.  Returns 0, or -1 with errno ETIMEDOUT.
+// min must be <= the most the cb can hold.
+int cb_wait_readable(cb_wait_t* w, size_t min, int timeout_ms);
+int cb_wait_writable(cb_wait_t* w, size_t min, int timeout_ms);
+
+void cb_wait_notify_readable(cb_wait_t* w);
+void cb_wait_notify_writable(cb_wait_t* w);
+
+#ifdef __cplusplus
+}
+#endif
@@ -120,6 +120,7 @@ enum op_e {
   OP_LEN,
   OP_CPY,
   OP_CMP,
+  OP_SKIP,
 };
 
 typedef struct {
@@ -143,7 +144,10 @@ static cbor_error_t read_bytes_like(cbor_stream_t* s, uint8_t mt, uint8_t ai, ui
 
     if (s->n < n) RET_ERROR(s, CBOR_ERROR_END_OF_STREAM);
 
-    if (op->op == OP_LEN) {
+    if (op->op == OP_SKIP) {
+      // Boundary only - nothing to check or copy
+    }
+    else if (op->op == OP_LEN) {
 #if !defined(CBOR_NO_UTF8)
       if ((mt == 3) && (!is_valid_utf8((const char*) s->b, (size_t) n))) {
         RET_ERROR(s, CBOR_ERROR_INVALID_UTF8);
@@ -764,6 +768,141 @@ cbor_error_t cbor_read_any(cbor_stream_t* s, cbor_value_t* v) {
   return CBOR_ERROR_NONE;
 }
 
+// Skips the next item using only the item headers - no cbor_value_t's are
+// built and containers are skipped by counting the headers of their entries.
+// The item is checked to be well-formed and to nest no deeper than
+// CBOR_MAX_RECURSION (as for read_any).  Unless strict, definite length
+// bytes/text are stepped over using their length, i.e. text is not checked
+// for UTF-8.  Tagged items are not converted so e.g. a malformed rational
+// is not detected.
+typedef struct {
+  uint64_t n;     // definite: items left, indefinite: items seen so far
+  bool     indef;
+  bool     map;
+} skip_level_t;
+
+static cbor_error_t skip_any(cbor_stream_t* s, bool strict) {
+  skip_level_t level[CBOR_MAX_RECURSION + 2];
+  size_t depth = 0;
+  level[0] = (skip_level_t) { .n = 1, .indef = false, .map = false };
+  bool self_describe = false;  // last header was tag 55799
+
+  while (true) {
+    skip_level_t* l = &level[depth];
+    if (!l->indef && (l->n == 0)) {
+      if (depth == 0) return CBOR_ERROR_NONE;
+      depth--;
+      continue;
+    }
+
+    uint8_t mt;
+    uint8_t ai;
+    uint64_t n;
+    CHECK(read_ext(s, &mt, &ai, &n));
+
+    if ((mt == 7) && (ai == 31)) {
+      // read_any needs an item after the marker
+      if (!l->indef || (strict && self_describe)) RET_ERROR(s, CBOR_ERROR_UNEXPECTED_BREAK);
+      if (l->map && (l->n % 2 != 0)) RET_ERROR(s, CBOR_ERROR_MAP_LENGTH);
+      depth--;
+      continue;
+    }
+
+    // Special case - self describe marker does not count as an item
+    self_describe = (mt == 6) && (n == 55799);
+    if (self_describe) continue;
+
+    if (depth > CBOR_MAX_RECURSION) RET_ERROR(s, CBOR_ERROR_RECURSION);
+    if (l->indef) l->n++; else l->n--;
+
+    switch (mt) {
+      case 2: // Byte string
+      case 3: { // Text string
+        op_t op = { .op = strict ? OP_LEN : OP_SKIP, .n = 0, .b = NULL, .r = 0 };
+        CHECK(read_bytes_like(s, mt, ai, n, &op));
+        break;
+      }
+
+      case 4: // Array
+      case 5: // Map
+        if (ai != 31) {
+          // Every entry takes at least one byte - also guards n += n below
+          if (n > (mt == 5 ? s->n / 2 : s->n)) RET_ERROR(s, CBOR_ERROR_END_OF_STREAM);
+          if (mt == 5) n += n;
+          if (n == 0) break;
+        }
+        depth++;
+        level[depth] = (skip_level_t) { .n = ai == 31 ? 0 : n, .indef = ai == 31, .map = mt == 5 };
+        break;
+
+      case 6: // Tag - followed by the tagged item
+        depth++;
+        level[depth] = (skip_level_t) { .n = 1, .indef = false, .map = false };
+        break;
+
+      case 7: // Simple
+        if ((ai == 24) && (n < 32)) RET_ERROR(s, CBOR_ERROR_BAD_SIMPLE_VALUE);
+        break;
+
+      default: // Unsigned and negative int - header only
+        break;
+    }
+  }
+}
+
+cbor_error_t cbor_skip_item(cbor_stream_t* s, cbor_skip_t mode) {
+  if (s == NULL) return CBOR_ERROR_NULL;
+  if (s->b == NULL) return CBOR_ERROR_NULL;
+  CHECK_ERROR(s);
+  return skip_any(s, mode == CBOR_SKIP_STRICT);
+}
+
+#if !defined(CBOR_SEQ_PREFETCH)
+#define CBOR_SEQ_PREFETCH (256)
+#endif
+
+#if defined(__GNUC__)
+#define PREFETCH(p) __builtin_prefetch(p)
+#else
+#define PREFETCH(p) do { } while (false)
+#endif
+
+cbor_error_t cbor_seq_init(cbor_seq_t* q, uint8_t* b, size_t n) {
+  if (q == NULL) return CBOR_ERROR_NULL;
+  q->b = b;
+  q->n = n;
+  if (b == NULL) return CBOR_ERROR_NULL;
+  return CBOR_ERROR_NONE;
+}
+
+cbor_error_t cbor_seq_read(cbor_seq_t* q, cbor_seq_item_t* items, size_t max, size_t* count) {
+  if ((q == NULL) || (items == NULL) || (count == NULL)) return CBOR_ERROR_NULL;
+  if (q->b == NULL) return CBOR_ERROR_NULL;
+
+  cbor_stream_t s = { .s = q->b, .b = q->b, .n = q->n, .error = CBOR_ERROR_NONE };
+  size_t i = 0;
+  while ((i < max) && (s.n > 0)) {
+    // Items are typically much smaller than the prefetch distance so this
+    // keeps the next few items in flight while the current one is walked.
+    if (s.n > CBOR_SEQ_PREFETCH) PREFETCH(s.b + CBOR_SEQ_PREFETCH);
+
+    uint8_t* start = s.b;
+    cbor_error_t e = skip_any(&s, false);
+    if (e != CBOR_ERROR_NONE) {
+      // q is left at the start of the bad or truncated item
+      *count = i;
+      return e;
+    }
+    items[i].b = start;
+    items[i].n = (size_t) (s.b - start);
+    i++;
+    q->b = s.b;
+    q->n = s.n;
+  }
+  *count = i;
+  return CBOR_ERROR_NONE;
+}
+
 #define CBOR_READ_0(name) \
   cbor_error_t cbor_read_ ## name(cbor_stream_t* s) { \
     cbor_value_t v; \
@@ -830,7 +969,7 @@ cbor_error_t cbor_get_any(cbor_stream_t *s, size_t n,
         }
       }
     }
-    CHECK(cbor_read_any(&s2, v));
+    CHECK(cbor_skip_item(&s2, CBOR_SKIP_STRICT));
   }
   return CBOR_ERROR_KEY_NOT_FOUND;
 }
@@ -1036,8 +1175,7 @@ cbor_error_t cbor_append(cbor_stream_t* s, const uint8_t* b, size_t n) {
 
 cbor_error_t cbor_skip(cbor_stream_t* s, size_t n) {
   while (n-- > 0) {
-    cbor_value_t v;
-    CHECK(cbor_read_any(s, &v));
+    CHECK(cbor_skip_item(s, CBOR_SKIP_STRICT));
   }
   return CBOR_ERROR_NONE;
 }
@@ -1639,7 +1777,7 @@ static cbor_error_t cbor_get_textn_stream(cbor_stream_t *s,
         }
       }
     }
-    CHECK(cbor_read_any(&s2, &v));
+    CHECK(cbor_skip_item(&s2, CBOR_SKIP_STRICT));
   }
   return CBOR_ERROR_KEY_NOT_FOUND;
 }
@@ -1668,7 +1806,7 @@ static cbor_error_t cbor_get_int_stream(cbor_stream_t *s,
         }
       }
     }
-    CHECK(cbor_read_any(&s2, &v));
+    CHECK(cbor_skip_item(&s2, CBOR_SKIP_STRICT));
   }
   return CBOR_ERROR_KEY_NOT_FOUND;
 }
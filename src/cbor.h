@@ -201,6 +201,41 @@ cbor_error_t cbor_error(const cbor_stream_t* s);
 // Reads the next value in the stream
 cbor_error_t cbor_read_any(cbor_stream_t* s, cbor_value_t* v);
 
+// Skips the next value in the stream without building any values.
+// Both modes check the item is well-formed and nests no deeper than
+// cbor_read_any allows.
+// CBOR_SKIP_TRUSTED steps over definite length bytes/text using their length.
+// CBOR_SKIP_STRICT also checks text is valid UTF-8, i.e. it accepts the same
+// items as cbor_read_any except that tagged values are not converted.
+typedef enum {
+  CBOR_SKIP_TRUSTED,
+  CBOR_SKIP_STRICT,
+} cbor_skip_t;
+
+cbor_error_t cbor_skip_item(cbor_stream_t* s, cbor_skip_t mode);
+
+// CBOR sequences (RFC 8742) - a buffer of concatenated top level items.
+// cbor_seq_read finds the boundaries of up to max items, storing them in
+// items[] and the number found in *count.  Items are only walked header by
+// header (checked to be well-formed, but text is not checked for UTF-8),
+// so pass each item to cbor_read_any or cbor_unpack for full decoding.
+// Returns CBOR_ERROR_NONE when max items were found or the buffer is used up.
+// Otherwise *count items were found before the error and the sequence is
+// left at the start of the failing item - CBOR_ERROR_END_OF_STREAM means
+// the last item is truncated, e.g. more data still to be received.
+typedef struct {
+  uint8_t* b;  // start of the next item
+  size_t   n;  // bytes left in the sequence
+} cbor_seq_t;
+
+typedef struct {
+  uint8_t* b;  // start of the item
+  size_t   n;  // size of the encoded item in bytes
+} cbor_seq_item_t;
+
+cbor_error_t cbor_seq_init(cbor_seq_t* q, uint8_t* b, size_t n);
+cbor_error_t cbor_seq_read(cbor_seq_t* q, cbor_seq_item_t* items, size_t max, size_t* count);
+
 // Gets an entry from a map using string key
 cbor_error_t cbor_get_any(cbor_stream_t *s, size_t n, const char* key, cbor_value_t* v);
 
@@ -0,0 +1,82 @@
+// © 2025 Unit Circle Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdbool.h>
+#include <string.h>
+#include "cbq.h"
+
+#define HDR 4u
+#define SKIP 0xffffffffu
+
+static inline size_t rec_size(size_t n) {
+  return HDR + ((n + 3u) & ~(size_t) 3u);
+}
+
+static inline uint32_t get_hdr(const void* p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline void put_hdr(void* p, uint32_t v) {
+  memcpy(p, &v, sizeof(v));
+}
+
+void cbq_init(cbq_t* q, void* b, size_t n) {
+  cb_init(&q->cb, b, n);
+  q->resv = NULL;
+}
+
+void* cbq_reserve(cbq_t* q, size_t n) {
+  size_t need = rec_size(n);
+  size_t space = cb_space_avail(&q->cb);
+  if ((space < need) && (space < cb_write_avail(&q->cb))) {
+    // Limited by the end of the buffer - skip to the start if the record
+    // would fit there.  Offsets are multiples of 4, so there is room for
+    // the marker.
+    if (cb_write_avail(&q->cb) - space < need) return NULL;
+    put_hdr((void*) cb_space(&q->cb), SKIP);
+    cb_commit(&q->cb, space);
+    space = cb_space_avail(&q->cb);
+  }
+  if (space < need) return NULL;
+  q->resv = (uint8_t*) cb_space(&q->cb);
+  return q->resv + HDR;
+}
+
+void cbq_commit(cbq_t* q, size_t n) {
+  put_hdr(q->resv, (uint32_t) n);
+  q->resv = NULL;
+  cb_commit(&q->cb, rec_size(n));
+}
+
+const void* cbq_peek(cbq_t* q, size_t* n) {
+  while (true) {
+    size_t avail = cb_peek_avail(&q->cb);
+    if (avail < HDR) return NULL;
+    const uint8_t* p = cb_peek(&q->cb);
+    uint32_t hdr = get_hdr(p);
+    if (hdr != SKIP) {
+      *n = hdr;
+      return p + HDR;
+    }
+    // Rest of the buffer is unused, all of it is committed so peek_avail
+    // is exactly up to the end
+    cb_skip(&q->cb, avail);
+  }
+}
+
+void cbq_release(cbq_t* q) {
+  cb_skip(&q->cb, rec_size(get_hdr(cb_peek(&q->cb))));
+}
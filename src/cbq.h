@@ -0,0 +1,59 @@
+// © 2025 Unit Circle Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cb.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Record queue on a cb_t - single producer/single consumer, zero copy.
+// Each record is a 4 byte length followed by the data, padded to 4 bytes,
+// and is never split by the wrap: if it does not fit before the end of the
+// buffer a skip marker fills the rest and it goes at the start.
+// So a record can take up to twice its size in the worst case - keep
+// records well under half the buffer.
+//
+// Producer:
+//   uint8_t* p = cbq_reserve(&q, max_n);  // NULL if no room (yet)
+//   ... fill p[0..n) ...
+//   cbq_commit(&q, n);                    // n <= max_n
+// Consumer:
+//   size_t n;
+//   const uint8_t* p = cbq_peek(&q, &n);  // NULL if empty
+//   ... use p[0..n) ...
+//   cbq_release(&q);
+
+typedef struct {
+  cb_t     cb;
+  uint8_t* resv; // record reserved by cbq_reserve
+} cbq_t;
+
+// b must be 4 byte aligned and n a multiple of 4.
+void cbq_init(cbq_t* q, void* b, size_t n);
+
+void* cbq_reserve(cbq_t* q, size_t n);
+void cbq_commit(cbq_t* q, size_t n);
+
+const void* cbq_peek(cbq_t* q, size_t* n);
+void cbq_release(cbq_t* q);
+
+#ifdef __cplusplus
+}
+#endif
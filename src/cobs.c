@@ -27,59 +27,426 @@
 
 #include <stdbool.h>
 #include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 #include "cobs.h"
 
+// Returns the index of the first 0x00 in b[0..n) or n if there is none.
+// Runs are at most 254 bytes so this is inlined rather than calling memchr.
+static inline size_t zero_idx(const uint8_t* b, size_t n) {
+  size_t i = 0;
+#if defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= n; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i*) (b + i));
+    unsigned m = (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(v, zero));
+    if (m != 0) return i + (size_t) __builtin_ctz(m);
+  }
+#else
+  // SWAR - word has a zero byte iff (w - 0x01..01) & ~w & 0x80..80 != 0
+  const uintptr_t ones = ((uintptr_t) -1) / 0xff;
+  for (; i + sizeof(uintptr_t) <= n; i += sizeof(uintptr_t)) {
+    uintptr_t w;
+    memcpy(&w, b + i, sizeof(w));
+    if (((w - ones) & ~w & (ones << 7)) != 0) break;
+  }
+#endif
+  for (; i < n; i++) {
+    if (b[i] == 0) return i;
+  }
+  return n;
+}
+
 size_t cobs_enc_size(size_t n) {
   return (n + 253)/254 + n;
 }
 
 size_t cobs_enc(uint8_t* out, const uint8_t* in, size_t n) {
+  // Each block is a run of up to 254 non-zero bytes, copied as a whole.
+  // The code byte is written after the run is moved, for "inplace" the
+  // output is always behind the input so memmove is needed for overlap.
   size_t nout = 0;
-  bool last_max = false;
-  out[0] = 1;
-  while (n-- > 0) {
-    last_max = false;
-    uint8_t v = *in++;
-    if (v == 0) {
-      nout += out[0];
-      out += out[0];
-      out[0] = 1;
+  while (true) {
+    size_t run = zero_idx(in, n < 254 ? n : 254);
+    bool zero = run < n && run < 254;
+    memmove(out + 1, in, run);
+    out[0] = (uint8_t) (run + 1);
+    out += run + 1;
+    nout += run + 1;
+    in += run;
+    n -= run;
+    if (zero) {
+      // Consume the 0x00 - always followed by another block
+      in++;
+      n--;
     }
-    else {
-      out[out[0]++] = v;
-      if (out[0] == 255) {
-        nout += out[0];
-        out += out[0];
-        out[0] = 1;
-        last_max = true;
-      }
+    else if ((run < 254) || (n == 0)) {
+      // Input done.  Implicit 0x00 terminator, except after a full block
+      break;
     }
   }
-  if (!last_max) {
-    // Implicit 0x00 terminator - so output last segment
-    nout += out[0];
-  }
   return nout;
 }
 
 ssize_t cobs_dec(uint8_t* out, const uint8_t* in, size_t n) {
-  bool out0 = false;
+  // Single pass - each code byte gives the run length, the run is checked
+  // for 0x00 and moved as a whole.  Output never passes the input so
+  // memmove makes "inplace" safe.
+  size_t nout = 0;
+  while (n > 0) {
+    uint8_t code = *in++;  n--;
+    if (code == 0) return -1; // Input must not contain 0x00
+    size_t run = code - 1u;
+    size_t avail = run < n ? run : n;
+    if (zero_idx(in, avail) != avail) return -1;
+    if (run > n) return -2;  // Insufficient input to decode last segment
+    memmove(out, in, run);
+    out += run;  nout += run;
+    in += run;   n -= run;
+    if ((code != 255) && (n > 0)) { *out++ = 0x00; nout++; }
+  }
+  return nout;
+}
+
+void cobs_enc_begin(cobs_enc_t* e, uint8_t* out) {
+  e->start = out;
+  e->code = out;
+  e->out = out + 1;
+  e->max = false;
+}
+
+void cobs_enc_update(cobs_enc_t* e, const uint8_t* in, size_t n) {
+  // As cobs_enc, but a block can span calls.  The code byte is only
+  // written when the block is closed.
+  while (n > 0) {
+    size_t run = (size_t) (e->out - e->code - 1);
+    size_t lim = n < 254 - run ? n : 254 - run;
+    size_t k = zero_idx(in, lim);
+    memmove(e->out, in, k);
+    e->out += k;
+    in += k;
+    n -= k;
+    if (k < lim) {
+      // Consume the 0x00
+      *e->code = (uint8_t) (run + k + 1);
+      e->code = e->out++;
+      e->max = false;
+      in++;
+      n--;
+    }
+    else if (run + k == 254) {
+      *e->code = 0xff;
+      e->code = e->out++;
+      e->max = true;
+    }
+  }
+}
+
+size_t cobs_enc_end(cobs_enc_t* e) {
+  size_t run = (size_t) (e->out - e->code - 1);
+  if (e->max && (run == 0)) {
+    // Implicit 0x00 terminator, except after a full block
+    e->out = e->code;
+  }
+  else {
+    *e->code = (uint8_t) (run + 1);
+  }
+  return (size_t) (e->out - e->start);
+}
+
+void cobs_dec_begin(cobs_dec_t* d, uint8_t* out) {
+  d->start = out;
+  d->out = out;
+  d->code = 0;
+  d->zero = false;
+}
+
+ssize_t cobs_dec_update(cobs_dec_t* d, const uint8_t* in, size_t n) {
+  // As cobs_dec, but the 0x00 ending a block is only written once the
+  // next block starts, as the last one is implicit.
+  uint8_t* out = d->out;
+  while (n > 0) {
+    if (d->code == 0) {
+      uint8_t code = *in++;  n--;
+      if (code == 0) return -1; // Input must not contain 0x00
+      if (d->zero) *d->out++ = 0x00;
+      d->zero = code != 255;
+      d->code = (uint8_t) (code - 1u);
+      continue;
+    }
+    size_t run = d->code < n ? d->code : n;
+    if (zero_idx(in, run) != run) return -1;
+    memmove(d->out, in, run);
+    d->out += run;
+    d->code -= (uint8_t) run;
+    in += run;
+    n -= run;
+  }
+  return d->out - out;
+}
+
+ssize_t cobs_dec_end(cobs_dec_t* d) {
+  if (d->code > 0) return -2;  // Insufficient input to decode last segment
+  return d->out - d->start;
+}
+
+// COBS/ZPE - as COBS but code bytes 0xe1..0xff mark a run of 0..30 bytes
+// followed by a pair of 0x00s and 0xe0 a run of 223 bytes with no 0x00.
+// Follows enc_zpe/dec_zpe in src-python/cobs.py - a frame always ends with
+// a block for the implicit 0x00, even after a 0xe0 block.
+size_t cobs_zpe_enc(uint8_t* out, const uint8_t* in, size_t n) {
+  size_t nout = 0;
+  while (true) {
+    size_t run = zero_idx(in, n < 0xdf ? n : 0xdf);
+    size_t used;
+    uint8_t code;
+    if (run == 0xdf) {
+      code = 0xe0;
+      used = run;
+    }
+    else if ((run <= 30) && (run < n) && ((run + 1 == n) || (in[run + 1] == 0))) {
+      // Pair of 0x00s - the second may be the implicit one
+      code = (uint8_t) (run + 0xe1);
+      used = run + 2;
+    }
+    else {
+      code = (uint8_t) (run + 1);
+      used = run + 1;
+    }
+    memmove(out + 1, in, run);
+    out[0] = code;
+    out += run + 1;
+    nout += run + 1;
+    if (used > n) break; // Implicit 0x00 used
+    in += used;
+    n -= used;
+  }
+  return nout;
+}
+
+ssize_t cobs_zpe_dec(uint8_t* out, const uint8_t* in, size_t n) {
+  // 0x00s owed by a block are written ahead of the next block's run, so the
+  // last one (the implicit 0x00) is never written.
+  size_t nout = 0;
+  size_t zeros = 0;
   uint8_t code = 0;
+  while (n > 0) {
+    code = *in++;  n--;
+    if (code == 0) return -1; // Input must not contain 0x00
+    size_t run = code < 0xe0 ? code - 1u : (code == 0xe0 ? 0xdfu : code - 0xe1u);
+    size_t avail = run < n ? run : n;
+    if (zero_idx(in, avail) != avail) return -1;
+    if (run > n) return -2;  // Insufficient input to decode last segment
+    memset(out, 0x00, zeros);
+    memmove(out + zeros, in, run);
+    out += zeros + run;  nout += zeros + run;
+    in += run;           n -= run;
+    zeros = code < 0xe0 ? 1 : (code == 0xe0 ? 0 : 2);
+  }
+  if (code == 0xe0) return -2; // Missing block for implicit 0x00
+  if (zeros > 1) { *out = 0x00; nout++; }
+  return (ssize_t) nout;
+}
+
+#if defined(COBS_HAS_IOVEC)
+size_t cobs_encv_size(const struct iovec* iov, int iovcnt) {
+  size_t n = 0;
+  for (int i = 0; i < iovcnt; i++) n += iov[i].iov_len;
+  return n == 0 ? 1 : cobs_enc_size(n);  // empty input still has a block
+}
+
+size_t cobs_encv(uint8_t* out, const struct iovec* iov, int iovcnt) {
+  cobs_enc_t e;
+  cobs_enc_begin(&e, out);
+  for (int i = 0; i < iovcnt; i++) {
+    cobs_enc_update(&e, iov[i].iov_base, iov[i].iov_len);
+  }
+  return cobs_enc_end(&e);
+}
+#endif
+
+// Decodes a frame ending at the first 0x00 in in[0..n), or at n.
+// *used is set to the offset of the 0x00 ending the frame.
+static ssize_t dec_frame(uint8_t* out, const uint8_t* in, size_t n, size_t* used) {
+  const uint8_t* start = in;
   size_t nout = 0;
-  if (memchr(in, 0x00, n) != NULL) return -1; // Input must not contain 0x00
+  while ((n > 0) && (*in != 0)) {
+    uint8_t code = *in++;  n--;
+    size_t run = code - 1u;
+    size_t avail = run < n ? run : n;
+    size_t z = zero_idx(in, avail);
+    if ((z != avail) || (run > n)) {
+      // Frame ended part way through a block
+      *used = (size_t) (in + z - start);
+      return -2;
+    }
+    memmove(out, in, run);
+    out += run;  nout += run;
+    in += run;   n -= run;
+    if ((code != 255) && (n > 0) && (*in != 0)) { *out++ = 0x00; nout++; }
+  }
+  *used = (size_t) (in - start);
+  return (ssize_t) nout;
+}
+
+size_t cobs_dec_batch(uint8_t* out, const uint8_t* in, size_t n,
+                      cobs_frame_t* f, size_t nf, size_t* used) {
+  // Only complete frames are decoded
+  while ((n > 0) && (in[n - 1] != 0)) n--;
+  size_t i = 0;
+  size_t nfr = 0;
+  while ((i < n) && (nfr < nf)) {
+    if (in[i] == 0) {
+      i++;
+      continue;
+    }
+    size_t k;
+    f[nfr].off = i;
+    f[nfr].n = dec_frame(out + i, in + i, n - i, &k);
+    nfr++;
+    i += k;
+  }
+  *used = i;
+  return nfr;
+}
+
+void cobs_stream_dec_init(cobs_stream_dec_t* d, uint8_t* b, size_t n,
+                          cobs_frame_fn_t fn, void* ctx) {
+  d->b = b;
+  d->n = n;
+  d->fn = fn;
+  d->ctx = ctx;
+  cobs_stream_dec_reset(d);
+}
+
+void cobs_stream_dec_reset(cobs_stream_dec_t* d) {
+  d->nout = 0;
+  d->code = 0;
+  d->zero = false;
+  d->start = false;
+  d->drop = false;
+}
+
+static void stream_dec_error(cobs_stream_dec_t* d, ssize_t e) {
+  d->fn(d->ctx, d->b, e);
+  cobs_stream_dec_reset(d);
+}
+
+void cobs_stream_dec(cobs_stream_dec_t* d, const uint8_t* in, size_t n) {
   while (n > 0) {
-    if (code == 0) {
-      if (out0) { *out++ = 0x00; nout++; }
-      code = *in++;  n--; // Code can't be 0x00 - memchr test above
-      out0 = code != 255;
-      code--;
+    if (d->drop) {
+      // Frame too long - discard up to the next delimiter
+      const uint8_t* z = memchr(in, 0x00, n);
+      if (z == NULL) return;
+      n -= (size_t) (z - in) + 1;
+      in = z + 1;
+      cobs_stream_dec_reset(d);
+    }
+    else if (d->code == 0) {
+      uint8_t code = *in++;  n--;
+      if (code == 0) {
+        // Delimiter - empty frames (back to back delimiters) are ignored
+        if (d->start) d->fn(d->ctx, d->b, (ssize_t) d->nout);
+        cobs_stream_dec_reset(d);
+        continue;
+      }
+      if (d->zero) {
+        if (d->nout == d->n) { stream_dec_error(d, -3); d->drop = true; continue; }
+        d->b[d->nout++] = 0x00;
+      }
+      d->zero = code != 255;
+      d->code = code - 1;
+      d->start = true;
     }
     else {
-      *out++ = *in++;
-      nout++; n--;
-      code--;
+      size_t run = d->code < n ? d->code : n;
+      size_t z = zero_idx(in, run);
+      if (z < run) {
+        // Delimiter inside a block
+        stream_dec_error(d, -2);
+        n -= z + 1;
+        in += z + 1;
+        continue;
+      }
+      if (d->n - d->nout < run) { stream_dec_error(d, -3); d->drop = true; continue; }
+      memcpy(d->b + d->nout, in, run);
+      d->nout += run;
+      d->code -= (uint8_t) run;
+      in += run;
+      n -= run;
+    }
+  }
+}
+
+void cobs_stream_enc_init(cobs_stream_enc_t* e) {
+  e->n = 0;
+  e->pos = 0;
+  e->ready = false;
+  e->last_max = false;
+  e->done = false;
+}
+
+static void stream_enc_block(cobs_stream_enc_t* e) {
+  e->blk[0] = e->n + 1;
+  e->last_max = e->n == 254;
+  e->n += 1;
+  e->pos = 0;
+  e->ready = true;
+}
+
+static size_t stream_enc_flush(cobs_stream_enc_t* e, uint8_t* out, size_t n_out) {
+  size_t k = e->n - e->pos;
+  if (k > n_out) k = n_out;
+  memcpy(out, e->blk + e->pos, k);
+  e->pos += (uint8_t) k;
+  if (e->pos == e->n) {
+    e->ready = false;
+    e->n = 0;
+  }
+  return k;
+}
+
+size_t cobs_stream_enc(cobs_stream_enc_t* e, uint8_t* out, size_t n_out,
+                       const uint8_t* in, size_t n_in, size_t* used) {
+  size_t nout = 0;
+  *used = 0;
+  while (true) {
+    if (e->ready) {
+      nout += stream_enc_flush(e, out + nout, n_out - nout);
+      if (e->ready) break; // out is full
+    }
+    if (*used == n_in) break;
+
+    // Add to the open block up to the next 0x00 or the 254 byte limit
+    size_t take = n_in - *used;
+    if (take > 254u - e->n) take = 254u - e->n;
+    size_t run = zero_idx(in + *used, take);
+    memcpy(e->blk + 1 + e->n, in + *used, run);
+    e->n += (uint8_t) run;
+    *used += run;
+    if (run < take) {
+      *used += 1; // 0x00 ends the block
+      stream_enc_block(e);
+    }
+    else if (e->n == 254) {
+      stream_enc_block(e);
+    }
+  }
+  return nout;
+}
+
+size_t cobs_stream_enc_end(cobs_stream_enc_t* e, uint8_t* out, size_t n_out) {
+  size_t nout = 0;
+  if (e->ready) nout += stream_enc_flush(e, out, n_out);
+  if (!e->ready && !e->done) {
+    // Implicit 0x00 terminator, except after a full block
+    e->done = true;
+    if ((e->n > 0) || !e->last_max) {
+      stream_enc_block(e);
+      nout += stream_enc_flush(e, out + nout, n_out - nout);
     }
   }
-  if (code >  0) return -2;  // Insufficient input to decode last segment
+  if (!e->ready && (nout == 0)) cobs_stream_enc_init(e);
   return nout;
 }
@@ -13,10 +13,17 @@
 // limitations under the License.
 
 #pragma once
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
 #include <sys/types.h>
+#if defined(__has_include)
+#if __has_include(<sys/uio.h>)
+#include <sys/uio.h>
+#define COBS_HAS_IOVEC 1
+#endif
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -28,6 +35,123 @@ size_t cobs_enc_size(size_t n);
 size_t cobs_enc(uint8_t* out, const uint8_t* in, size_t n);
 ssize_t cobs_dec(uint8_t* out, const uint8_t* in, size_t n);
 
+// Incremental COBS encode/decode - for when the data is produced or
+// consumed in pieces (e.g. to CRC each piece while it is in cache).
+// Output is the same as cobs_enc/cobs_dec of the concatenated input, and
+// "inplace" use follows the same rules.
+//   cobs_enc_begin(&e, out);
+//   cobs_enc_update(&e, in1, n1);  cobs_enc_update(&e, in2, n2); ...
+//   size_t n_out = cobs_enc_end(&e);
+// cobs_dec_update returns the number of bytes appended to out (these are
+// final), or -1 if the input contains 0x00.  cobs_dec_end returns the total
+// decoded length, or -2 if the input ended part way through a block.
+typedef struct {
+  uint8_t* start; // start of output
+  uint8_t* code;  // code byte of the current block
+  uint8_t* out;   // next byte of the current block
+  bool     max;   // previous block was a full 254 bytes
+} cobs_enc_t;
+
+typedef struct {
+  uint8_t* start; // start of output
+  uint8_t* out;   // next output byte
+  uint8_t  code;  // bytes left in current block
+  bool     zero;  // 0x00 due before the next block
+} cobs_dec_t;
+
+void cobs_enc_begin(cobs_enc_t* e, uint8_t* out);
+void cobs_enc_update(cobs_enc_t* e, const uint8_t* in, size_t n);
+size_t cobs_enc_end(cobs_enc_t* e);
+
+void cobs_dec_begin(cobs_dec_t* d, uint8_t* out);
+ssize_t cobs_dec_update(cobs_dec_t* d, const uint8_t* in, size_t n);
+ssize_t cobs_dec_end(cobs_dec_t* d);
+
+#if defined(COBS_HAS_IOVEC)
+// Scatter-gather encode - iov[0..iovcnt) is encoded as if it was one buffer
+// (e.g. header, body and CRC), avoiding a copy to concatenate them.
+// out must have room for cobs_encv_size bytes and not overlap the input.
+size_t cobs_encv_size(const struct iovec* iov, int iovcnt);
+size_t cobs_encv(uint8_t* out, const struct iovec* iov, int iovcnt);
+#endif
+
+// COBS/ZPE (zero pair elimination) - pairs of 0x00 are encoded in the code
+// byte, so frames with many zero pairs (e.g. little endian integers,
+// padding) are shorter than with COBS.  Not compatible with COBS framing.
+// Encode "inplace" as for cobs_enc, using COBS_ZPE_ENC_SIZE.
+// Decoding can produce more bytes than are read, so out must have room for
+// COBS_ZPE_DEC_SIZE(n) bytes.  To decode "inplace" place the input at the
+// end of a buffer of COBS_ZPE_DEC_SIZE(n) bytes with out at the start.
+#define COBS_ZPE_ENC_SIZE(n_) ((n_)/223u + 1u + (n_))
+#define COBS_ZPE_DEC_SIZE(n_) (2u*(n_))
+
+size_t cobs_zpe_enc(uint8_t* out, const uint8_t* in, size_t n);
+ssize_t cobs_zpe_dec(uint8_t* out, const uint8_t* in, size_t n);
+
+// Batch decode of a buffer of 0x00 delimited frames (e.g. a capture or a
+// drained receive ring).  Each frame is decoded to out at the offset it has
+// in in, so out may be in.  Frames are found while decoding, there is no
+// separate scan for delimiters.  Empty frames are skipped and a partial
+// frame at the end (no closing 0x00) is left for the next call.
+// Returns the number of entries written to f (at most nf), *used is the
+// offset in in to continue from.  For each frame n is the decoded length, or
+// -2 if a 0x00 was found part way through a block.
+typedef struct {
+  size_t  off; // offset of frame in in/out
+  ssize_t n;   // decoded length or error
+} cobs_frame_t;
+
+size_t cobs_dec_batch(uint8_t* out, const uint8_t* in, size_t n,
+                      cobs_frame_t* f, size_t nf, size_t* used);
+
+// Streaming decoder for 0x00 delimited frames arriving in arbitrary chunks,
+// e.g. from read() or cb_peek().  Frames are decoded on the fly into b and
+// passed to fn as they complete - n is the decoded length, or negative:
+//   -2 frame ended part way through a block
+//   -3 frame does not fit in b (rest of frame is discarded)
+// Empty frames (back to back delimiters) are ignored.
+// b is reused for the next frame once fn returns.
+typedef void (*cobs_frame_fn_t)(void* ctx, uint8_t* b, ssize_t n);
+
+typedef struct {
+  uint8_t* b;     // frame buffer
+  size_t   n;     // size of frame buffer
+  size_t   nout;  // bytes decoded into b
+  uint8_t  code;  // bytes left in current block
+  bool     zero;  // 0x00 due before the next block
+  bool     start; // code byte seen for the current frame
+  bool     drop;  // discarding until the next delimiter
+  cobs_frame_fn_t fn;
+  void*    ctx;
+} cobs_stream_dec_t;
+
+void cobs_stream_dec_init(cobs_stream_dec_t* d, uint8_t* b, size_t n,
+                          cobs_frame_fn_t fn, void* ctx);
+void cobs_stream_dec_reset(cobs_stream_dec_t* d);
+void cobs_stream_dec(cobs_stream_dec_t* d, const uint8_t* in, size_t n);
+
+// Streaming encoder for frames too large to hold encoded in one buffer,
+// e.g. firmware images.  Input is taken as it is available and output
+// is produced in chunks of any size - at most one 255 byte block is held.
+// cobs_stream_enc encodes from in[0..n_in) into out[0..n_out), returning
+// the bytes written and setting *used to the input consumed.  Input is only
+// left unused when out is full.  Once all input has been given call
+// cobs_stream_enc_end (with n_out > 0) until it returns 0, the encoder is
+// then ready for the next frame.  Output matches cobs_enc.
+typedef struct {
+  uint8_t blk[255]; // code byte + data of the open or output block
+  uint8_t n;        // data bytes in open block or bytes in output block
+  uint8_t pos;      // bytes of output block already written
+  bool    ready;    // blk holds a complete block to output
+  bool    last_max; // last complete block was 254 bytes without 0x00
+  bool    done;     // last block added
+} cobs_stream_enc_t;
+
+void cobs_stream_enc_init(cobs_stream_enc_t* e);
+size_t cobs_stream_enc(cobs_stream_enc_t* e, uint8_t* out, size_t n_out,
+                       const uint8_t* in, size_t n_in, size_t* used);
+size_t cobs_stream_enc_end(cobs_stream_enc_t* e, uint8_t* out, size_t n_out);
+
 #ifdef __cplusplus
 }
 #endif
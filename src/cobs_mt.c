@@ -0,0 +1,126 @@
+// © 2025 Unit Circle Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+#include "cobs_mt.h"
+
+// Below this a buffer is not worth splitting
+#define MT_MIN (64u * 1024u)
+#define MT_MAX_THREADS 64u
+
+typedef struct {
+  uint8_t*       out;
+  const uint8_t* in;
+  size_t         n;
+  cobs_frame_t*  f;
+  size_t         nf;     // frames in the part, then frames to decode
+  size_t         nfr;
+  size_t         used;
+} part_t;
+
+// A frame is a run of non-zero bytes - as cobs_dec_batch splits them,
+// including bad frames
+static void* count_part(void* arg) {
+  part_t* p = arg;
+  size_t i = 0;
+  p->nf = 0;
+  while (i < p->n) {
+    if (p->in[i] == 0) {
+      i++;
+      continue;
+    }
+    p->nf++;
+    const uint8_t* z = memchr(p->in + i, 0x00, p->n - i);
+    i = z == NULL ? p->n : (size_t) (z - p->in) + 1;
+  }
+  return NULL;
+}
+
+static void* dec_part(void* arg) {
+  part_t* p = arg;
+  p->nfr = cobs_dec_batch(p->out, p->in, p->n, p->f, p->nf, &p->used);
+  return NULL;
+}
+
+// Runs fn on p[1..np) on their own threads (or here if one cannot be
+// started) and on p[0] on this thread
+static void run_parts(part_t* p, unsigned np, void* (*fn)(void*)) {
+  pthread_t th[MT_MAX_THREADS];
+  bool started[MT_MAX_THREADS];
+  for (unsigned t = 1; t < np; t++) {
+    started[t] = pthread_create(&th[t], NULL, fn, &p[t]) == 0;
+    if (!started[t]) fn(&p[t]);
+  }
+  fn(&p[0]);
+  for (unsigned t = 1; t < np; t++) {
+    if (started[t]) pthread_join(th[t], NULL);
+  }
+}
+
+size_t cobs_dec_batch_mt(uint8_t* out, const uint8_t* in, size_t n,
+                         cobs_frame_t* f, size_t nf, size_t* used,
+                         unsigned nthreads) {
+  if (nthreads > MT_MAX_THREADS) nthreads = MT_MAX_THREADS;
+  if ((nthreads < 2) || (n < MT_MIN) || (nf == 0)) {
+    return cobs_dec_batch(out, in, n, f, nf, used);
+  }
+
+  // Only complete frames are decoded
+  while ((n > 0) && (in[n - 1] != 0)) n--;
+  if (n == 0) {
+    *used = 0;
+    return 0;
+  }
+
+  // Split just after a 0x00, so each part is whole frames
+  part_t p[MT_MAX_THREADS];
+  size_t lo = 0;
+  unsigned np = 0;
+  for (unsigned t = 0; (t < nthreads) && (lo < n); t++) {
+    size_t hi = t + 1 == nthreads ? n : (size_t) ((n / nthreads) * (t + 1));
+    if (hi < lo) hi = lo;
+    if (hi < n) {
+      const uint8_t* z = memchr(in + hi, 0x00, n - hi);
+      hi = (size_t) (z - in) + 1;
+    }
+    p[np++] = (part_t) { .out = out + lo, .in = in + lo, .n = hi - lo };
+    lo = hi;
+  }
+
+  // Count the frames in each part, then give each part its slice of f -
+  // decoding stops where f fills, as cobs_dec_batch does, so nothing past
+  // *used is written.  A part that fits is allowed one more frame than it
+  // has, so that (like cobs_dec_batch with room to spare) it steps over
+  // the delimiters at its end.
+  run_parts(p, np, count_part);
+  size_t total = 0;
+  unsigned nd = 0;
+  while ((nd < np) && (total < nf)) {
+    size_t k = p[nd].nf < nf - total ? p[nd].nf : nf - total;
+    p[nd].f = f + total;
+    p[nd].nf = k < nf - total ? k + 1 : k;
+    total += k;
+    nd++;
+  }
+  run_parts(p, nd, dec_part);
+
+  for (unsigned t = 0; t < nd; t++) {
+    size_t base = (size_t) (p[t].in - in);
+    for (size_t i = 0; i < p[t].nfr; i++) p[t].f[i].off += base;
+  }
+  *used = (size_t) (p[nd - 1].in - in) + p[nd - 1].used;
+  return total;
+}
@@ -0,0 +1,37 @@
+// © 2025 Unit Circle Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cobs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// As cobs_dec_batch, but the buffer is split at frame boundaries and the
+// parts are decoded on up to nthreads threads (POSIX hosts only - not part
+// of the Zephyr library).  Small buffers are decoded on the calling thread.
+// The frames in each part are counted first, so the result (including
+// when f fills up) is the same as cobs_dec_batch - nothing past *used is
+// written, and out == in is fine.
+size_t cobs_dec_batch_mt(uint8_t* out, const uint8_t* in, size_t n,
+                         cobs_frame_t* f, size_t nf, size_t* used,
+                         unsigned nthreads);
+
+#ifdef __cplusplus
+}
+#endif
@@ -23,8 +23,35 @@ extern "C" {
 #define CRC32C_INIT (0)
 #define CRC32C_OK_REM (0x48674bc7)
 
+// On x86-64 (gcc/clang) the SSE4.2 crc32 instruction is used when the CPU
+// has it, checked at first use.  Define CRC32C_NO_HW to always use the table.
+// CRC32C_SLICE (1, 8 or 16) sets the bytes per step of the table CRC,
+// trading table size (1, 8 or 16 KB) for speed - see crc32c.c.
 uint32_t crc32c_update(uint32_t crc, const uint8_t* data, size_t n);
 
+// out[i] = crc32c_update(CRC32C_INIT, bufs[i], lens[i]) for count packets.
+// With hardware CRC the packets are interleaved, which is faster for many
+// short packets than a crc32c_update each.
+void crc32c_multi(const uint8_t* const bufs[], const size_t lens[],
+                  uint32_t out[], size_t count);
+
+// Copy n bytes from src to dst (not overlapping) and return the crc updated
+// with them - the data is only read from memory once.  See also
+// cb_read_crc32c for reading from a cb_t.
+uint32_t crc32c_copy(void* dst, const void* src, size_t n, uint32_t crc);
+
+// Combine crc1 of A and crc2 of B (len2 bytes) into the crc of A|B without
+// reading the data, e.g. to merge crcs of chunks done in parallel, or to
+// add a header to a frame crc.  O(log len2).  For many combines with the
+// same len2, generate the operator once:
+//   uint32_t op = crc32c_combine_gen(len2);
+//   crc = crc32c_combine_op(crc1, crc2, op);
+// op must come from crc32c_combine_gen (it is never 0 - a 0 op, e.g. a
+// zero initialised one, just returns crc2).
+uint32_t crc32c_combine(uint32_t crc1, uint32_t crc2, size_t len2);
+uint32_t crc32c_combine_gen(size_t len2);
+uint32_t crc32c_combine_op(uint32_t crc1, uint32_t crc2, uint32_t op);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,67 @@
+// © 2025 Unit Circle Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <pthread.h>
+#include <stdbool.h>
+#include "crc32c_mt.h"
+
+// Below this the thread start up costs more than it saves
+#define MT_MIN (1024u * 1024u)
+#define MT_MAX_THREADS 64u
+
+typedef struct {
+  const uint8_t* data;
+  size_t         n;
+  uint32_t       crc;
+} part_t;
+
+static void* crc_part(void* arg) {
+  part_t* p = arg;
+  p->crc = crc32c_update(p->crc, p->data, p->n);
+  return NULL;
+}
+
+uint32_t crc32c_parallel(uint32_t crc, const uint8_t* data, size_t n,
+                         unsigned nthreads) {
+  if (nthreads > MT_MAX_THREADS) nthreads = MT_MAX_THREADS;
+  if ((nthreads < 2) || (n < MT_MIN)) return crc32c_update(crc, data, n);
+
+  // Equal chunks, rounded to 64 bytes, the first carries crc in
+  part_t p[MT_MAX_THREADS];
+  pthread_t th[MT_MAX_THREADS];
+  bool started[MT_MAX_THREADS];
+  size_t chunk = (n / nthreads) & ~(size_t) 63;
+  for (unsigned t = 0; t < nthreads; t++) {
+    p[t] = (part_t) {
+      .data = data + t * chunk,
+      .n = t + 1 == nthreads ? n - t * chunk : chunk,
+      .crc = t == 0 ? crc : CRC32C_INIT,
+    };
+  }
+  for (unsigned t = 1; t < nthreads; t++) {
+    started[t] = pthread_create(&th[t], NULL, crc_part, &p[t]) == 0;
+    if (!started[t]) crc_part(&p[t]);
+  }
+  crc_part(&p[0]);
+
+  // All but the last chunk are the same length
+  uint32_t op = crc32c_combine_gen(chunk);
+  crc = p[0].crc;
+  for (unsigned t = 1; t < nthreads; t++) {
+    if (started[t]) pthread_join(th[t], NULL);
+    crc = t + 1 == nthreads ? crc32c_combine(crc, p[t].crc, p[t].n)
+                            : crc32c_combine_op(crc, p[t].crc, op);
+  }
+  return crc;
+}
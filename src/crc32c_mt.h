@@ -0,0 +1,35 @@
+// © 2025 Unit Circle Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "crc32c.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// As crc32c_update, but the buffer is split into up to nthreads chunks done
+// on their own threads and merged with crc32c_combine (POSIX hosts only -
+// not part of the Zephyr library).  Small buffers are done on the calling
+// thread.  To use your own workers, crc32c_update each chunk from
+// CRC32C_INIT and merge in order with crc32c_combine.
+uint32_t crc32c_parallel(uint32_t crc, const uint8_t* data, size_t n,
+                         unsigned nthreads);
+
+#ifdef __cplusplus
+}
+#endif
@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+// Generated by src-python/crc32c.py - do not edit.
+
 #pragma once
 
 static const uint32_t crc32c_tab[256] = {
@@ -81,3 +83,15 @@ static const uint32_t crc32c_tab[256] = {
   0xbe2da0a5, 0x4c4623a6, 0x5f16d052, 0xad7d5351,
 };
 #define CRC32C_OK_REM (0x48674bc7)
+
+// x^(2^k) mod P
+static const uint32_t crc32c_x2n[32] = {
+  0x40000000, 0x20000000, 0x08000000, 0x00800000,
+  0x00008000, 0x82f63b78, 0x6ea2d55c, 0x18b8ea18,
+  0x510ac59a, 0xb82be955, 0xb8fdb1e7, 0x88e56f72,
+  0x74c360a4, 0xe4172b16, 0x0d65762a, 0x35d73a62,
+  0x28461564, 0xbf455269, 0xe2ea32dc, 0xfe7740e6,
+  0xf946610b, 0x3c204f8f, 0x538586e3, 0x59726915,
+  0x734d5309, 0xbc1ac763, 0x7d0722cc, 0xd289cabe,
+  0xe94ca9bc, 0x05b74f3f, 0xa51e1f42, 0x40000000,
+};
@@ -0,0 +1,562 @@
+// © 2025 Unit Circle Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Generated by src-python/crc32c.py - do not edit.
+
+#pragma once
+
+#define CRC32C_LONG  (8192)
+#define CRC32C_SHORT (256)
+
+static const uint32_t crc32c_long[4][256] = {
+  {
+    0x00000000, 0xe040e0ac, 0xc56db7a9, 0x252d5705,
+    0x8f3719a3, 0x6f77f90f, 0x4a5aae0a, 0xaa1a4ea6,
+    0x1b8245b7, 0xfbc2a51b, 0xdeeff21e, 0x3eaf12b2,
+    0x94b55c14, 0x74f5bcb8, 0x51d8ebbd, 0xb1980b11,
+    0x37048b6e, 0xd7446bc2, 0xf2693cc7, 0x1229dc6b,
+    0xb83392cd, 0x58737261, 0x7d5e2564, 0x9d1ec5c8,
+    0x2c86ced9, 0xccc62e75, 0xe9eb7970, 0x09ab99dc,
+    0xa3b1d77a, 0x43f137d6, 0x66dc60d3, 0x869c807f,
+    0x6e0916dc, 0x8e49f670, 0xab64a175, 0x4b2441d9,
+    0xe13e0f7f, 0x017eefd3, 0x2453b8d6, 0xc413587a,
+    0x758b536b, 0x95cbb3c7, 0xb0e6e4c2, 0x50a6046e,
+    0xfabc4ac8, 0x1afcaa64, 0x3fd1fd61, 0xdf911dcd,
+    0x590d9db2, 0xb94d7d1e, 0x9c602a1b, 0x7c20cab7,
+    0xd63a8411, 0x367a64bd, 0x135733b8, 0xf317d314,
+    0x428fd805, 0xa2cf38a9, 0x87e26fac, 0x67a28f00,
+    0xcdb8c1a6, 0x2df8210a, 0x08d5760f, 0xe89596a3,
+    0xdc122db8, 0x3c52cd14, 0x197f9a11, 0xf93f7abd,
+    0x5325341b, 0xb365d4b7, 0x964883b2, 0x7608631e,
+    0xc790680f, 0x27d088a3, 0x02fddfa6, 0xe2bd3f0a,
+    0x48a771ac, 0xa8e79100, 0x8dcac605, 0x6d8a26a9,
+    0xeb16a6d6, 0x0b56467a, 0x2e7b117f, 0xce3bf1d3,
+    0x6421bf75, 0x84615fd9, 0xa14c08dc, 0x410ce870,
+    0xf094e361, 0x10d403cd, 0x35f954c8, 0xd5b9b464,
+    0x7fa3fac2, 0x9fe31a6e, 0xbace4d6b, 0x5a8eadc7,
+    0xb21b3b64, 0x525bdbc8, 0x77768ccd, 0x97366c61,
+    0x3d2c22c7, 0xdd6cc26b, 0xf841956e, 0x180175c2,
+    0xa9997ed3, 0x49d99e7f, 0x6cf4c97a, 0x8cb429d6,
+    0x26ae6770, 0xc6ee87dc, 0xe3c3d0d9, 0x03833075,
+    0x851fb00a, 0x655f50a6, 0x407207a3, 0xa032e70f,
+    0x0a28a9a9, 0xea684905, 0xcf451e00, 0x2f05feac,
+    0x9e9df5bd, 0x7edd1511, 0x5bf04214, 0xbbb0a2b8,
+    0x11aaec1e, 0xf1ea0cb2, 0xd4c75bb7, 0x3487bb1b,
+    0xbdc82d81, 0x5d88cd2d, 0x78a59a28, 0x98e57a84,
+    0x32ff3422, 0xd2bfd48e, 0xf792838b, 0x17d26327,
+    0xa64a6836, 0x460a889a, 0x6327df9f, 0x83673f33,
+    0x297d7195, 0xc93d9139, 0xec10c63c, 0x0c502690,
+    0x8acca6ef, 0x6a8c4643, 0x4fa11146, 0xafe1f1ea,
+    0x05fbbf4c, 0xe5bb5fe0, 0xc09608e5, 0x20d6e849,
+    0x914ee358, 0x710e03f4, 0x542354f1, 0xb463b45d,
+    0x1e79fafb, 0xfe391a57, 0xdb144d52, 0x3b54adfe,
+    0xd3c13b5d, 0x3381dbf1, 0x16ac8cf4, 0xf6ec6c58,
+    0x5cf622fe, 0xbcb6c252, 0x999b9557, 0x79db75fb,
+    0xc8437eea, 0x28039e46, 0x0d2ec943, 0xed6e29ef,
+    0x47746749, 0xa73487e5, 0x8219d0e0, 0x6259304c,
+    0xe4c5b033, 0x0485509f, 0x21a8079a, 0xc1e8e736,
+    0x6bf2a990, 0x8bb2493c, 0xae9f1e39, 0x4edffe95,
+    0xff47f584, 0x1f071528, 0x3a2a422d, 0xda6aa281,
+    0x7070ec27, 0x90300c8b, 0xb51d5b8e, 0x555dbb22,
+    0x61da0039, 0x819ae095, 0xa4b7b790, 0x44f7573c,
+    0xeeed199a, 0x0eadf936, 0x2b80ae33, 0xcbc04e9f,
+    0x7a58458e, 0x9a18a522, 0xbf35f227, 0x5f75128b,
+    0xf56f5c2d, 0x152fbc81, 0x3002eb84, 0xd0420b28,
+    0x56de8b57, 0xb69e6bfb, 0x93b33cfe, 0x73f3dc52,
+    0xd9e992f4, 0x39a97258, 0x1c84255d, 0xfcc4c5f1,
+    0x4d5ccee0, 0xad1c2e4c, 0x88317949, 0x687199e5,
+    0xc26bd743, 0x222b37ef, 0x070660ea, 0xe7468046,
+    0x0fd316e5, 0xef93f649, 0xcabea14c, 0x2afe41e0,
+    0x80e40f46, 0x60a4efea, 0x4589b8ef, 0xa5c95843,
+    0x14515352, 0xf411b3fe, 0xd13ce4fb, 0x317c0457,
+    0x9b664af1, 0x7b26aa5d, 0x5e0bfd58, 0xbe4b1df4,
+    0x38d79d8b, 0xd8977d27, 0xfdba2a22, 0x1dfaca8e,
+    0xb7e08428, 0x57a06484, 0x728d3381, 0x92cdd32d,
+    0x2355d83c, 0xc3153890, 0xe6386f95, 0x06788f39,
+    0xac62c19f, 0x4c222133, 0x690f7636, 0x894f969a,
+  },
+  {
+    0x00000000, 0x7e7c2df3, 0xfcf85be6, 0x82847615,
+    0xfc1cc13d, 0x8260ecce, 0x00e49adb, 0x7e98b728,
+    0xfdd5f48b, 0x83a9d978, 0x012daf6d, 0x7f51829e,
+    0x01c935b6, 0x7fb51845, 0xfd316e50, 0x834d43a3,
+    0xfe479fe7, 0x803bb214, 0x02bfc401, 0x7cc3e9f2,
+    0x025b5eda, 0x7c277329, 0xfea3053c, 0x80df28cf,
+    0x03926b6c, 0x7dee469f, 0xff6a308a, 0x81161d79,
+    0xff8eaa51, 0x81f287a2, 0x0376f1b7, 0x7d0adc44,
+    0xf963493f, 0x871f64cc, 0x059b12d9, 0x7be73f2a,
+    0x057f8802, 0x7b03a5f1, 0xf987d3e4, 0x87fbfe17,
+    0x04b6bdb4, 0x7aca9047, 0xf84ee652, 0x8632cba1,
+    0xf8aa7c89, 0x86d6517a, 0x0452276f, 0x7a2e0a9c,
+    0x0724d6d8, 0x7958fb2b, 0xfbdc8d3e, 0x85a0a0cd,
+    0xfb3817e5, 0x85443a16, 0x07c04c03, 0x79bc61f0,
+    0xfaf12253, 0x848d0fa0, 0x060979b5, 0x78755446,
+    0x06ede36e, 0x7891ce9d, 0xfa15b888, 0x8469957b,
+    0xf72ae48f, 0x8956c97c, 0x0bd2bf69, 0x75ae929a,
+    0x0b3625b2, 0x754a0841, 0xf7ce7e54, 0x89b253a7,
+    0x0aff1004, 0x74833df7, 0xf6074be2, 0x887b6611,
+    0xf6e3d139, 0x889ffcca, 0x0a1b8adf, 0x7467a72c,
+    0x096d7b68, 0x7711569b, 0xf595208e, 0x8be90d7d,
+    0xf571ba55, 0x8b0d97a6, 0x0989e1b3, 0x77f5cc40,
+    0xf4b88fe3, 0x8ac4a210, 0x0840d405, 0x763cf9f6,
+    0x08a44ede, 0x76d8632d, 0xf45c1538, 0x8a2038cb,
+    0x0e49adb0, 0x70358043, 0xf2b1f656, 0x8ccddba5,
+    0xf2556c8d, 0x8c29417e, 0x0ead376b, 0x70d11a98,
+    0xf39c593b, 0x8de074c8, 0x0f6402dd, 0x71182f2e,
+    0x0f809806, 0x71fcb5f5, 0xf378c3e0, 0x8d04ee13,
+    0xf00e3257, 0x8e721fa4, 0x0cf669b1, 0x728a4442,
+    0x0c12f36a, 0x726ede99, 0xf0eaa88c, 0x8e96857f,
+    0x0ddbc6dc, 0x73a7eb2f, 0xf1239d3a, 0x8f5fb0c9,
+    0xf1c707e1, 0x8fbb2a12, 0x0d3f5c07, 0x734371f4,
+    0xebb9bfef, 0x95c5921c, 0x1741e409, 0x693dc9fa,
+    0x17a57ed2, 0x69d95321, 0xeb5d2534, 0x952108c7,
+    0x166c4b64, 0x68106697, 0xea941082, 0x94e83d71,
+    0xea708a59, 0x940ca7aa, 0x1688d1bf, 0x68f4fc4c,
+    0x15fe2008, 0x6b820dfb, 0xe9067bee, 0x977a561d,
+    0xe9e2e135, 0x979eccc6, 0x151abad3, 0x6b669720,
+    0xe82bd483, 0x9657f970, 0x14d38f65, 0x6aafa296,
+    0x143715be, 0x6a4b384d, 0xe8cf4e58, 0x96b363ab,
+    0x12daf6d0, 0x6ca6db23, 0xee22ad36, 0x905e80c5,
+    0xeec637ed, 0x90ba1a1e, 0x123e6c0b, 0x6c4241f8,
+    0xef0f025b, 0x91732fa8, 0x13f759bd, 0x6d8b744e,
+    0x1313c366, 0x6d6fee95, 0xefeb9880, 0x9197b573,
+    0xec9d6937, 0x92e144c4, 0x106532d1, 0x6e191f22,
+    0x1081a80a, 0x6efd85f9, 0xec79f3ec, 0x9205de1f,
+    0x11489dbc, 0x6f34b04f, 0xedb0c65a, 0x93cceba9,
+    0xed545c81, 0x93287172, 0x11ac0767, 0x6fd02a94,
+    0x1c935b60, 0x62ef7693, 0xe06b0086, 0x9e172d75,
+    0xe08f9a5d, 0x9ef3b7ae, 0x1c77c1bb, 0x620bec48,
+    0xe146afeb, 0x9f3a8218, 0x1dbef40d, 0x63c2d9fe,
+    0x1d5a6ed6, 0x63264325, 0xe1a23530, 0x9fde18c3,
+    0xe2d4c487, 0x9ca8e974, 0x1e2c9f61, 0x6050b292,
+    0x1ec805ba, 0x60b42849, 0xe2305e5c, 0x9c4c73af,
+    0x1f01300c, 0x617d1dff, 0xe3f96bea, 0x9d854619,
+    0xe31df131, 0x9d61dcc2, 0x1fe5aad7, 0x61998724,
+    0xe5f0125f, 0x9b8c3fac, 0x190849b9, 0x6774644a,
+    0x19ecd362, 0x6790fe91, 0xe5148884, 0x9b68a577,
+    0x1825e6d4, 0x6659cb27, 0xe4ddbd32, 0x9aa190c1,
+    0xe43927e9, 0x9a450a1a, 0x18c17c0f, 0x66bd51fc,
+    0x1bb78db8, 0x65cba04b, 0xe74fd65e, 0x9933fbad,
+    0xe7ab4c85, 0x99d76176, 0x1b531763, 0x652f3a90,
+    0xe6627933, 0x981e54c0, 0x1a9a22d5, 0x64e60f26,
+    0x1a7eb80e, 0x640295fd, 0xe686e3e8, 0x98face1b,
+  },
+  {
+    0x00000000, 0xd29f092f, 0xa0d264af, 0x724d6d80,
+    0x4448bfaf, 0x96d7b680, 0xe49adb00, 0x3605d22f,
+    0x88917f5e, 0x5a0e7671, 0x28431bf1, 0xfadc12de,
+    0xccd9c0f1, 0x1e46c9de, 0x6c0ba45e, 0xbe94ad71,
+    0x14ce884d, 0xc6518162, 0xb41cece2, 0x6683e5cd,
+    0x508637e2, 0x82193ecd, 0xf054534d, 0x22cb5a62,
+    0x9c5ff713, 0x4ec0fe3c, 0x3c8d93bc, 0xee129a93,
+    0xd81748bc, 0x0a884193, 0x78c52c13, 0xaa5a253c,
+    0x299d109a, 0xfb0219b5, 0x894f7435, 0x5bd07d1a,
+    0x6dd5af35, 0xbf4aa61a, 0xcd07cb9a, 0x1f98c2b5,
+    0xa10c6fc4, 0x739366eb, 0x01de0b6b, 0xd3410244,
+    0xe544d06b, 0x37dbd944, 0x4596b4c4, 0x9709bdeb,
+    0x3d5398d7, 0xefcc91f8, 0x9d81fc78, 0x4f1ef557,
+    0x791b2778, 0xab842e57, 0xd9c943d7, 0x0b564af8,
+    0xb5c2e789, 0x675deea6, 0x15108326, 0xc78f8a09,
+    0xf18a5826, 0x23155109, 0x51583c89, 0x83c735a6,
+    0x533a2134, 0x81a5281b, 0xf3e8459b, 0x21774cb4,
+    0x17729e9b, 0xc5ed97b4, 0xb7a0fa34, 0x653ff31b,
+    0xdbab5e6a, 0x09345745, 0x7b793ac5, 0xa9e633ea,
+    0x9fe3e1c5, 0x4d7ce8ea, 0x3f31856a, 0xedae8c45,
+    0x47f4a979, 0x956ba056, 0xe726cdd6, 0x35b9c4f9,
+    0x03bc16d6, 0xd1231ff9, 0xa36e7279, 0x71f17b56,
+    0xcf65d627, 0x1dfadf08, 0x6fb7b288, 0xbd28bba7,
+    0x8b2d6988, 0x59b260a7, 0x2bff0d27, 0xf9600408,
+    0x7aa731ae, 0xa8383881, 0xda755501, 0x08ea5c2e,
+    0x3eef8e01, 0xec70872e, 0x9e3deaae, 0x4ca2e381,
+    0xf2364ef0, 0x20a947df, 0x52e42a5f, 0x807b2370,
+    0xb67ef15f, 0x64e1f870, 0x16ac95f0, 0xc4339cdf,
+    0x6e69b9e3, 0xbcf6b0cc, 0xcebbdd4c, 0x1c24d463,
+    0x2a21064c, 0xf8be0f63, 0x8af362e3, 0x586c6bcc,
+    0xe6f8c6bd, 0x3467cf92, 0x462aa212, 0x94b5ab3d,
+    0xa2b07912, 0x702f703d, 0x02621dbd, 0xd0fd1492,
+    0xa6744268, 0x74eb4b47, 0x06a626c7, 0xd4392fe8,
+    0xe23cfdc7, 0x30a3f4e8, 0x42ee9968, 0x90719047,
+    0x2ee53d36, 0xfc7a3419, 0x8e375999, 0x5ca850b6,
+    0x6aad8299, 0xb8328bb6, 0xca7fe636, 0x18e0ef19,
+    0xb2baca25, 0x6025c30a, 0x1268ae8a, 0xc0f7a7a5,
+    0xf6f2758a, 0x246d7ca5, 0x56201125, 0x84bf180a,
+    0x3a2bb57b, 0xe8b4bc54, 0x9af9d1d4, 0x4866d8fb,
+    0x7e630ad4, 0xacfc03fb, 0xdeb16e7b, 0x0c2e6754,
+    0x8fe952f2, 0x5d765bdd, 0x2f3b365d, 0xfda43f72,
+    0xcba1ed5d, 0x193ee472, 0x6b7389f2, 0xb9ec80dd,
+    0x07782dac, 0xd5e72483, 0xa7aa4903, 0x7535402c,
+    0x43309203, 0x91af9b2c, 0xe3e2f6ac, 0x317dff83,
+    0x9b27dabf, 0x49b8d390, 0x3bf5be10, 0xe96ab73f,
+    0xdf6f6510, 0x0df06c3f, 0x7fbd01bf, 0xad220890,
+    0x13b6a5e1, 0xc129acce, 0xb364c14e, 0x61fbc861,
+    0x57fe1a4e, 0x85611361, 0xf72c7ee1, 0x25b377ce,
+    0xf54e635c, 0x27d16a73, 0x559c07f3, 0x87030edc,
+    0xb106dcf3, 0x6399d5dc, 0x11d4b85c, 0xc34bb173,
+    0x7ddf1c02, 0xaf40152d, 0xdd0d78ad, 0x0f927182,
+    0x3997a3ad, 0xeb08aa82, 0x9945c702, 0x4bdace2d,
+    0xe180eb11, 0x331fe23e, 0x41528fbe, 0x93cd8691,
+    0xa5c854be, 0x77575d91, 0x051a3011, 0xd785393e,
+    0x6911944f, 0xbb8e9d60, 0xc9c3f0e0, 0x1b5cf9cf,
+    0x2d592be0, 0xffc622cf, 0x8d8b4f4f, 0x5f144660,
+    0xdcd373c6, 0x0e4c7ae9, 0x7c011769, 0xae9e1e46,
+    0x989bcc69, 0x4a04c546, 0x3849a8c6, 0xead6a1e9,
+    0x54420c98, 0x86dd05b7, 0xf4906837, 0x260f6118,
+    0x100ab337, 0xc295ba18, 0xb0d8d798, 0x6247deb7,
+    0xc81dfb8b, 0x1a82f2a4, 0x68cf9f24, 0xba50960b,
+    0x8c554424, 0x5eca4d0b, 0x2c87208b, 0xfe1829a4,
+    0x408c84d5, 0x92138dfa, 0xe05ee07a, 0x32c1e955,
+    0x04c43b7a, 0xd65b3255, 0xa4165fd5, 0x768956fa,
+  },
+  {
+    0x00000000, 0x4904f221, 0x9209e442, 0xdb0d1663,
+    0x21ffbe75, 0x68fb4c54, 0xb3f65a37, 0xfaf2a816,
+    0x43ff7cea, 0x0afb8ecb, 0xd1f698a8, 0x98f26a89,
+    0x6200c29f, 0x2b0430be, 0xf00926dd, 0xb90dd4fc,
+    0x87fef9d4, 0xcefa0bf5, 0x15f71d96, 0x5cf3efb7,
+    0xa60147a1, 0xef05b580, 0x3408a3e3, 0x7d0c51c2,
+    0xc401853e, 0x8d05771f, 0x5608617c, 0x1f0c935d,
+    0xe5fe3b4b, 0xacfac96a, 0x77f7df09, 0x3ef32d28,
+    0x0a118559, 0x43157778, 0x9818611b, 0xd11c933a,
+    0x2bee3b2c, 0x62eac90d, 0xb9e7df6e, 0xf0e32d4f,
+    0x49eef9b3, 0x00ea0b92, 0xdbe71df1, 0x92e3efd0,
+    0x681147c6, 0x2115b5e7, 0xfa18a384, 0xb31c51a5,
+    0x8def7c8d, 0xc4eb8eac, 0x1fe698cf, 0x56e26aee,
+    0xac10c2f8, 0xe51430d9, 0x3e1926ba, 0x771dd49b,
+    0xce100067, 0x8714f246, 0x5c19e425, 0x151d1604,
+    0xefefbe12, 0xa6eb4c33, 0x7de65a50, 0x34e2a871,
+    0x14230ab2, 0x5d27f893, 0x862aeef0, 0xcf2e1cd1,
+    0x35dcb4c7, 0x7cd846e6, 0xa7d55085, 0xeed1a2a4,
+    0x57dc7658, 0x1ed88479, 0xc5d5921a, 0x8cd1603b,
+    0x7623c82d, 0x3f273a0c, 0xe42a2c6f, 0xad2ede4e,
+    0x93ddf366, 0xdad90147, 0x01d41724, 0x48d0e505,
+    0xb2224d13, 0xfb26bf32, 0x202ba951, 0x692f5b70,
+    0xd0228f8c, 0x99267dad, 0x422b6bce, 0x0b2f99ef,
+    0xf1dd31f9, 0xb8d9c3d8, 0x63d4d5bb, 0x2ad0279a,
+    0x1e328feb, 0x57367dca, 0x8c3b6ba9, 0xc53f9988,
+    0x3fcd319e, 0x76c9c3bf, 0xadc4d5dc, 0xe4c027fd,
+    0x5dcdf301, 0x14c90120, 0xcfc41743, 0x86c0e562,
+    0x7c324d74, 0x3536bf55, 0xee3ba936, 0xa73f5b17,
+    0x99cc763f, 0xd0c8841e, 0x0bc5927d, 0x42c1605c,
+    0xb833c84a, 0xf1373a6b, 0x2a3a2c08, 0x633ede29,
+    0xda330ad5, 0x9337f8f4, 0x483aee97, 0x013e1cb6,
+    0xfbccb4a0, 0xb2c84681, 0x69c550e2, 0x20c1a2c3,
+    0x28461564, 0x6142e745, 0xba4ff126, 0xf34b0307,
+    0x09b9ab11, 0x40bd5930, 0x9bb04f53, 0xd2b4bd72,
+    0x6bb9698e, 0x22bd9baf, 0xf9b08dcc, 0xb0b47fed,
+    0x4a46d7fb, 0x034225da, 0xd84f33b9, 0x914bc198,
+    0xafb8ecb0, 0xe6bc1e91, 0x3db108f2, 0x74b5fad3,
+    0x8e4752c5, 0xc743a0e4, 0x1c4eb687, 0x554a44a6,
+    0xec47905a, 0xa543627b, 0x7e4e7418, 0x374a8639,
+    0xcdb82e2f, 0x84bcdc0e, 0x5fb1ca6d, 0x16b5384c,
+    0x2257903d, 0x6b53621c, 0xb05e747f, 0xf95a865e,
+    0x03a82e48, 0x4aacdc69, 0x91a1ca0a, 0xd8a5382b,
+    0x61a8ecd7, 0x28ac1ef6, 0xf3a10895, 0xbaa5fab4,
+    0x405752a2, 0x0953a083, 0xd25eb6e0, 0x9b5a44c1,
+    0xa5a969e9, 0xecad9bc8, 0x37a08dab, 0x7ea47f8a,
+    0x8456d79c, 0xcd5225bd, 0x165f33de, 0x5f5bc1ff,
+    0xe6561503, 0xaf52e722, 0x745ff141, 0x3d5b0360,
+    0xc7a9ab76, 0x8ead5957, 0x55a04f34, 0x1ca4bd15,
+    0x3c651fd6, 0x7561edf7, 0xae6cfb94, 0xe76809b5,
+    0x1d9aa1a3, 0x549e5382, 0x8f9345e1, 0xc697b7c0,
+    0x7f9a633c, 0x369e911d, 0xed93877e, 0xa497755f,
+    0x5e65dd49, 0x17612f68, 0xcc6c390b, 0x8568cb2a,
+    0xbb9be602, 0xf29f1423, 0x29920240, 0x6096f061,
+    0x9a645877, 0xd360aa56, 0x086dbc35, 0x41694e14,
+    0xf8649ae8, 0xb16068c9, 0x6a6d7eaa, 0x23698c8b,
+    0xd99b249d, 0x909fd6bc, 0x4b92c0df, 0x029632fe,
+    0x36749a8f, 0x7f7068ae, 0xa47d7ecd, 0xed798cec,
+    0x178b24fa, 0x5e8fd6db, 0x8582c0b8, 0xcc863299,
+    0x758be665, 0x3c8f1444, 0xe7820227, 0xae86f006,
+    0x54745810, 0x1d70aa31, 0xc67dbc52, 0x8f794e73,
+    0xb18a635b, 0xf88e917a, 0x23838719, 0x6a877538,
+    0x9075dd2e, 0xd9712f0f, 0x027c396c, 0x4b78cb4d,
+    0xf2751fb1, 0xbb71ed90, 0x607cfbf3, 0x297809d2,
+    0xd38aa1c4, 0x9a8e53e5, 0x41834586, 0x0887b7a7,
+  },
+};
+
+static const uint32_t crc32c_short[4][256] = {
+  {
+    0x00000000, 0xdcb17aa4, 0xbc8e83b9, 0x603ff91d,
+    0x7cf17183, 0xa0400b27, 0xc07ff23a, 0x1cce889e,
+    0xf9e2e306, 0x255399a2, 0x456c60bf, 0x99dd1a1b,
+    0x85139285, 0x59a2e821, 0x399d113c, 0xe52c6b98,
+    0xf629b0fd, 0x2a98ca59, 0x4aa73344, 0x961649e0,
+    0x8ad8c17e, 0x5669bbda, 0x365642c7, 0xeae73863,
+    0x0fcb53fb, 0xd37a295f, 0xb345d042, 0x6ff4aae6,
+    0x733a2278, 0xaf8b58dc, 0xcfb4a1c1, 0x1305db65,
+    0xe9bf170b, 0x350e6daf, 0x553194b2, 0x8980ee16,
+    0x954e6688, 0x49ff1c2c, 0x29c0e531, 0xf5719f95,
+    0x105df40d, 0xccec8ea9, 0xacd377b4, 0x70620d10,
+    0x6cac858e, 0xb01dff2a, 0xd0220637, 0x0c937c93,
+    0x1f96a7f6, 0xc327dd52, 0xa318244f, 0x7fa95eeb,
+    0x6367d675, 0xbfd6acd1, 0xdfe955cc, 0x03582f68,
+    0xe67444f0, 0x3ac53e54, 0x5afac749, 0x864bbded,
+    0x9a853573, 0x46344fd7, 0x260bb6ca, 0xfabacc6e,
+    0xd69258e7, 0x0a232243, 0x6a1cdb5e, 0xb6ada1fa,
+    0xaa632964, 0x76d253c0, 0x16edaadd, 0xca5cd079,
+    0x2f70bbe1, 0xf3c1c145, 0x93fe3858, 0x4f4f42fc,
+    0x5381ca62, 0x8f30b0c6, 0xef0f49db, 0x33be337f,
+    0x20bbe81a, 0xfc0a92be, 0x9c356ba3, 0x40841107,
+    0x5c4a9999, 0x80fbe33d, 0xe0c41a20, 0x3c756084,
+    0xd9590b1c, 0x05e871b8, 0x65d788a5, 0xb966f201,
+    0xa5a87a9f, 0x7919003b, 0x1926f926, 0xc5978382,
+    0x3f2d4fec, 0xe39c3548, 0x83a3cc55, 0x5f12b6f1,
+    0x43dc3e6f, 0x9f6d44cb, 0xff52bdd6, 0x23e3c772,
+    0xc6cfacea, 0x1a7ed64e, 0x7a412f53, 0xa6f055f7,
+    0xba3edd69, 0x668fa7cd, 0x06b05ed0, 0xda012474,
+    0xc904ff11, 0x15b585b5, 0x758a7ca8, 0xa93b060c,
+    0xb5f58e92, 0x6944f436, 0x097b0d2b, 0xd5ca778f,
+    0x30e61c17, 0xec5766b3, 0x8c689fae, 0x50d9e50a,
+    0x4c176d94, 0x90a61730, 0xf099ee2d, 0x2c289489,
+    0xa8c8c73f, 0x7479bd9b, 0x14464486, 0xc8f73e22,
+    0xd439b6bc, 0x0888cc18, 0x68b73505, 0xb4064fa1,
+    0x512a2439, 0x8d9b5e9d, 0xeda4a780, 0x3115dd24,
+    0x2ddb55ba, 0xf16a2f1e, 0x9155d603, 0x4de4aca7,
+    0x5ee177c2, 0x82500d66, 0xe26ff47b, 0x3ede8edf,
+    0x22100641, 0xfea17ce5, 0x9e9e85f8, 0x422fff5c,
+    0xa70394c4, 0x7bb2ee60, 0x1b8d177d, 0xc73c6dd9,
+    0xdbf2e547, 0x07439fe3, 0x677c66fe, 0xbbcd1c5a,
+    0x4177d034, 0x9dc6aa90, 0xfdf9538d, 0x21482929,
+    0x3d86a1b7, 0xe137db13, 0x8108220e, 0x5db958aa,
+    0xb8953332, 0x64244996, 0x041bb08b, 0xd8aaca2f,
+    0xc46442b1, 0x18d53815, 0x78eac108, 0xa45bbbac,
+    0xb75e60c9, 0x6bef1a6d, 0x0bd0e370, 0xd76199d4,
+    0xcbaf114a, 0x171e6bee, 0x772192f3, 0xab90e857,
+    0x4ebc83cf, 0x920df96b, 0xf2320076, 0x2e837ad2,
+    0x324df24c, 0xeefc88e8, 0x8ec371f5, 0x52720b51,
+    0x7e5a9fd8, 0xa2ebe57c, 0xc2d41c61, 0x1e6566c5,
+    0x02abee5b, 0xde1a94ff, 0xbe256de2, 0x62941746,
+    0x87b87cde, 0x5b09067a, 0x3b36ff67, 0xe78785c3,
+    0xfb490d5d, 0x27f877f9, 0x47c78ee4, 0x9b76f440,
+    0x88732f25, 0x54c25581, 0x34fdac9c, 0xe84cd638,
+    0xf4825ea6, 0x28332402, 0x480cdd1f, 0x94bda7bb,
+    0x7191cc23, 0xad20b687, 0xcd1f4f9a, 0x11ae353e,
+    0x0d60bda0, 0xd1d1c704, 0xb1ee3e19, 0x6d5f44bd,
+    0x97e588d3, 0x4b54f277, 0x2b6b0b6a, 0xf7da71ce,
+    0xeb14f950, 0x37a583f4, 0x579a7ae9, 0x8b2b004d,
+    0x6e076bd5, 0xb2b61171, 0xd289e86c, 0x0e3892c8,
+    0x12f61a56, 0xce4760f2, 0xae7899ef, 0x72c9e34b,
+    0x61cc382e, 0xbd7d428a, 0xdd42bb97, 0x01f3c133,
+    0x1d3d49ad, 0xc18c3309, 0xa1b3ca14, 0x7d02b0b0,
+    0x982edb28, 0x449fa18c, 0x24a05891, 0xf8112235,
+    0xe4dfaaab, 0x386ed00f, 0x58512912, 0x84e053b6,
+  },
+  {
+    0x00000000, 0x547df88f, 0xa8fbf11e, 0xfc860991,
+    0x541b94cd, 0x00666c42, 0xfce065d3, 0xa89d9d5c,
+    0xa837299a, 0xfc4ad115, 0x00ccd884, 0x54b1200b,
+    0xfc2cbd57, 0xa85145d8, 0x54d74c49, 0x00aab4c6,
+    0x558225c5, 0x01ffdd4a, 0xfd79d4db, 0xa9042c54,
+    0x0199b108, 0x55e44987, 0xa9624016, 0xfd1fb899,
+    0xfdb50c5f, 0xa9c8f4d0, 0x554efd41, 0x013305ce,
+    0xa9ae9892, 0xfdd3601d, 0x0155698c, 0x55289103,
+    0xab044b8a, 0xff79b305, 0x03ffba94, 0x5782421b,
+    0xff1fdf47, 0xab6227c8, 0x57e42e59, 0x0399d6d6,
+    0x03336210, 0x574e9a9f, 0xabc8930e, 0xffb56b81,
+    0x5728f6dd, 0x03550e52, 0xffd307c3, 0xabaeff4c,
+    0xfe866e4f, 0xaafb96c0, 0x567d9f51, 0x020067de,
+    0xaa9dfa82, 0xfee0020d, 0x02660b9c, 0x561bf313,
+    0x56b147d5, 0x02ccbf5a, 0xfe4ab6cb, 0xaa374e44,
+    0x02aad318, 0x56d72b97, 0xaa512206, 0xfe2cda89,
+    0x53e4e1e5, 0x0799196a, 0xfb1f10fb, 0xaf62e874,
+    0x07ff7528, 0x53828da7, 0xaf048436, 0xfb797cb9,
+    0xfbd3c87f, 0xafae30f0, 0x53283961, 0x0755c1ee,
+    0xafc85cb2, 0xfbb5a43d, 0x0733adac, 0x534e5523,
+    0x0666c420, 0x521b3caf, 0xae9d353e, 0xfae0cdb1,
+    0x527d50ed, 0x0600a862, 0xfa86a1f3, 0xaefb597c,
+    0xae51edba, 0xfa2c1535, 0x06aa1ca4, 0x52d7e42b,
+    0xfa4a7977, 0xae3781f8, 0x52b18869, 0x06cc70e6,
+    0xf8e0aa6f, 0xac9d52e0, 0x501b5b71, 0x0466a3fe,
+    0xacfb3ea2, 0xf886c62d, 0x0400cfbc, 0x507d3733,
+    0x50d783f5, 0x04aa7b7a, 0xf82c72eb, 0xac518a64,
+    0x04cc1738, 0x50b1efb7, 0xac37e626, 0xf84a1ea9,
+    0xad628faa, 0xf91f7725, 0x05997eb4, 0x51e4863b,
+    0xf9791b67, 0xad04e3e8, 0x5182ea79, 0x05ff12f6,
+    0x0555a630, 0x51285ebf, 0xadae572e, 0xf9d3afa1,
+    0x514e32fd, 0x0533ca72, 0xf9b5c3e3, 0xadc83b6c,
+    0xa7c9c3ca, 0xf3b43b45, 0x0f3232d4, 0x5b4fca5b,
+    0xf3d25707, 0xa7afaf88, 0x5b29a619, 0x0f545e96,
+    0x0ffeea50, 0x5b8312df, 0xa7051b4e, 0xf378e3c1,
+    0x5be57e9d, 0x0f988612, 0xf31e8f83, 0xa763770c,
+    0xf24be60f, 0xa6361e80, 0x5ab01711, 0x0ecdef9e,
+    0xa65072c2, 0xf22d8a4d, 0x0eab83dc, 0x5ad67b53,
+    0x5a7ccf95, 0x0e01371a, 0xf2873e8b, 0xa6fac604,
+    0x0e675b58, 0x5a1aa3d7, 0xa69caa46, 0xf2e152c9,
+    0x0ccd8840, 0x58b070cf, 0xa436795e, 0xf04b81d1,
+    0x58d61c8d, 0x0cabe402, 0xf02ded93, 0xa450151c,
+    0xa4faa1da, 0xf0875955, 0x0c0150c4, 0x587ca84b,
+    0xf0e13517, 0xa49ccd98, 0x581ac409, 0x0c673c86,
+    0x594fad85, 0x0d32550a, 0xf1b45c9b, 0xa5c9a414,
+    0x0d543948, 0x5929c1c7, 0xa5afc856, 0xf1d230d9,
+    0xf178841f, 0xa5057c90, 0x59837501, 0x0dfe8d8e,
+    0xa56310d2, 0xf11ee85d, 0x0d98e1cc, 0x59e51943,
+    0xf42d222f, 0xa050daa0, 0x5cd6d331, 0x08ab2bbe,
+    0xa036b6e2, 0xf44b4e6d, 0x08cd47fc, 0x5cb0bf73,
+    0x5c1a0bb5, 0x0867f33a, 0xf4e1faab, 0xa09c0224,
+    0x08019f78, 0x5c7c67f7, 0xa0fa6e66, 0xf48796e9,
+    0xa1af07ea, 0xf5d2ff65, 0x0954f6f4, 0x5d290e7b,
+    0xf5b49327, 0xa1c96ba8, 0x5d4f6239, 0x09329ab6,
+    0x09982e70, 0x5de5d6ff, 0xa163df6e, 0xf51e27e1,
+    0x5d83babd, 0x09fe4232, 0xf5784ba3, 0xa105b32c,
+    0x5f2969a5, 0x0b54912a, 0xf7d298bb, 0xa3af6034,
+    0x0b32fd68, 0x5f4f05e7, 0xa3c90c76, 0xf7b4f4f9,
+    0xf71e403f, 0xa363b8b0, 0x5fe5b121, 0x0b9849ae,
+    0xa305d4f2, 0xf7782c7d, 0x0bfe25ec, 0x5f83dd63,
+    0x0aab4c60, 0x5ed6b4ef, 0xa250bd7e, 0xf62d45f1,
+    0x5eb0d8ad, 0x0acd2022, 0xf64b29b3, 0xa236d13c,
+    0xa29c65fa, 0xf6e19d75, 0x0a6794e4, 0x5e1a6c6b,
+    0xf687f137, 0xa2fa09b8, 0x5e7c0029, 0x0a01f8a6,
+  },
+  {
+    0x00000000, 0x4a7ff165, 0x94ffe2ca, 0xde8013af,
+    0x2c13b365, 0x666c4200, 0xb8ec51af, 0xf293a0ca,
+    0x582766ca, 0x125897af, 0xccd88400, 0x86a77565,
+    0x7434d5af, 0x3e4b24ca, 0xe0cb3765, 0xaab4c600,
+    0xb04ecd94, 0xfa313cf1, 0x24b12f5e, 0x6ecede3b,
+    0x9c5d7ef1, 0xd6228f94, 0x08a29c3b, 0x42dd6d5e,
+    0xe869ab5e, 0xa2165a3b, 0x7c964994, 0x36e9b8f1,
+    0xc47a183b, 0x8e05e95e, 0x5085faf1, 0x1afa0b94,
+    0x6571edd9, 0x2f0e1cbc, 0xf18e0f13, 0xbbf1fe76,
+    0x49625ebc, 0x031dafd9, 0xdd9dbc76, 0x97e24d13,
+    0x3d568b13, 0x77297a76, 0xa9a969d9, 0xe3d698bc,
+    0x11453876, 0x5b3ac913, 0x85badabc, 0xcfc52bd9,
+    0xd53f204d, 0x9f40d128, 0x41c0c287, 0x0bbf33e2,
+    0xf92c9328, 0xb353624d, 0x6dd371e2, 0x27ac8087,
+    0x8d184687, 0xc767b7e2, 0x19e7a44d, 0x53985528,
+    0xa10bf5e2, 0xeb740487, 0x35f41728, 0x7f8be64d,
+    0xcae3dbb2, 0x809c2ad7, 0x5e1c3978, 0x1463c81d,
+    0xe6f068d7, 0xac8f99b2, 0x720f8a1d, 0x38707b78,
+    0x92c4bd78, 0xd8bb4c1d, 0x063b5fb2, 0x4c44aed7,
+    0xbed70e1d, 0xf4a8ff78, 0x2a28ecd7, 0x60571db2,
+    0x7aad1626, 0x30d2e743, 0xee52f4ec, 0xa42d0589,
+    0x56bea543, 0x1cc15426, 0xc2414789, 0x883eb6ec,
+    0x228a70ec, 0x68f58189, 0xb6759226, 0xfc0a6343,
+    0x0e99c389, 0x44e632ec, 0x9a662143, 0xd019d026,
+    0xaf92366b, 0xe5edc70e, 0x3b6dd4a1, 0x711225c4,
+    0x8381850e, 0xc9fe746b, 0x177e67c4, 0x5d0196a1,
+    0xf7b550a1, 0xbdcaa1c4, 0x634ab26b, 0x2935430e,
+    0xdba6e3c4, 0x91d912a1, 0x4f59010e, 0x0526f06b,
+    0x1fdcfbff, 0x55a30a9a, 0x8b231935, 0xc15ce850,
+    0x33cf489a, 0x79b0b9ff, 0xa730aa50, 0xed4f5b35,
+    0x47fb9d35, 0x0d846c50, 0xd3047fff, 0x997b8e9a,
+    0x6be82e50, 0x2197df35, 0xff17cc9a, 0xb5683dff,
+    0x902bc195, 0xda5430f0, 0x04d4235f, 0x4eabd23a,
+    0xbc3872f0, 0xf6478395, 0x28c7903a, 0x62b8615f,
+    0xc80ca75f, 0x8273563a, 0x5cf34595, 0x168cb4f0,
+    0xe41f143a, 0xae60e55f, 0x70e0f6f0, 0x3a9f0795,
+    0x20650c01, 0x6a1afd64, 0xb49aeecb, 0xfee51fae,
+    0x0c76bf64, 0x46094e01, 0x98895dae, 0xd2f6accb,
+    0x78426acb, 0x323d9bae, 0xecbd8801, 0xa6c27964,
+    0x5451d9ae, 0x1e2e28cb, 0xc0ae3b64, 0x8ad1ca01,
+    0xf55a2c4c, 0xbf25dd29, 0x61a5ce86, 0x2bda3fe3,
+    0xd9499f29, 0x93366e4c, 0x4db67de3, 0x07c98c86,
+    0xad7d4a86, 0xe702bbe3, 0x3982a84c, 0x73fd5929,
+    0x816ef9e3, 0xcb110886, 0x15911b29, 0x5feeea4c,
+    0x4514e1d8, 0x0f6b10bd, 0xd1eb0312, 0x9b94f277,
+    0x690752bd, 0x2378a3d8, 0xfdf8b077, 0xb7874112,
+    0x1d338712, 0x574c7677, 0x89cc65d8, 0xc3b394bd,
+    0x31203477, 0x7b5fc512, 0xa5dfd6bd, 0xefa027d8,
+    0x5ac81a27, 0x10b7eb42, 0xce37f8ed, 0x84480988,
+    0x76dba942, 0x3ca45827, 0xe2244b88, 0xa85bbaed,
+    0x02ef7ced, 0x48908d88, 0x96109e27, 0xdc6f6f42,
+    0x2efccf88, 0x64833eed, 0xba032d42, 0xf07cdc27,
+    0xea86d7b3, 0xa0f926d6, 0x7e793579, 0x3406c41c,
+    0xc69564d6, 0x8cea95b3, 0x526a861c, 0x18157779,
+    0xb2a1b179, 0xf8de401c, 0x265e53b3, 0x6c21a2d6,
+    0x9eb2021c, 0xd4cdf379, 0x0a4de0d6, 0x403211b3,
+    0x3fb9f7fe, 0x75c6069b, 0xab461534, 0xe139e451,
+    0x13aa449b, 0x59d5b5fe, 0x8755a651, 0xcd2a5734,
+    0x679e9134, 0x2de16051, 0xf36173fe, 0xb91e829b,
+    0x4b8d2251, 0x01f2d334, 0xdf72c09b, 0x950d31fe,
+    0x8ff73a6a, 0xc588cb0f, 0x1b08d8a0, 0x517729c5,
+    0xa3e4890f, 0xe99b786a, 0x371b6bc5, 0x7d649aa0,
+    0xd7d05ca0, 0x9dafadc5, 0x432fbe6a, 0x09504f0f,
+    0xfbc3efc5, 0xb1bc1ea0, 0x6f3c0d0f, 0x2543fc6a,
+  },
+  {
+    0x00000000, 0x25bbf5db, 0x4b77ebb6, 0x6ecc1e6d,
+    0x96efd76c, 0xb35422b7, 0xdd983cda, 0xf823c901,
+    0x2833d829, 0x0d882df2, 0x6344339f, 0x46ffc644,
+    0xbedc0f45, 0x9b67fa9e, 0xf5abe4f3, 0xd0101128,
+    0x5067b052, 0x75dc4589, 0x1b105be4, 0x3eabae3f,
+    0xc688673e, 0xe33392e5, 0x8dff8c88, 0xa8447953,
+    0x7854687b, 0x5def9da0, 0x332383cd, 0x16987616,
+    0xeebbbf17, 0xcb004acc, 0xa5cc54a1, 0x8077a17a,
+    0xa0cf60a4, 0x8574957f, 0xebb88b12, 0xce037ec9,
+    0x3620b7c8, 0x139b4213, 0x7d575c7e, 0x58eca9a5,
+    0x88fcb88d, 0xad474d56, 0xc38b533b, 0xe630a6e0,
+    0x1e136fe1, 0x3ba89a3a, 0x55648457, 0x70df718c,
+    0xf0a8d0f6, 0xd513252d, 0xbbdf3b40, 0x9e64ce9b,
+    0x6647079a, 0x43fcf241, 0x2d30ec2c, 0x088b19f7,
+    0xd89b08df, 0xfd20fd04, 0x93ece369, 0xb65716b2,
+    0x4e74dfb3, 0x6bcf2a68, 0x05033405, 0x20b8c1de,
+    0x4472b7b9, 0x61c94262, 0x0f055c0f, 0x2abea9d4,
+    0xd29d60d5, 0xf726950e, 0x99ea8b63, 0xbc517eb8,
+    0x6c416f90, 0x49fa9a4b, 0x27368426, 0x028d71fd,
+    0xfaaeb8fc, 0xdf154d27, 0xb1d9534a, 0x9462a691,
+    0x141507eb, 0x31aef230, 0x5f62ec5d, 0x7ad91986,
+    0x82fad087, 0xa741255c, 0xc98d3b31, 0xec36ceea,
+    0x3c26dfc2, 0x199d2a19, 0x77513474, 0x52eac1af,
+    0xaac908ae, 0x8f72fd75, 0xe1bee318, 0xc40516c3,
+    0xe4bdd71d, 0xc10622c6, 0xafca3cab, 0x8a71c970,
+    0x72520071, 0x57e9f5aa, 0x3925ebc7, 0x1c9e1e1c,
+    0xcc8e0f34, 0xe935faef, 0x87f9e482, 0xa2421159,
+    0x5a61d858, 0x7fda2d83, 0x111633ee, 0x34adc635,
+    0xb4da674f, 0x91619294, 0xffad8cf9, 0xda167922,
+    0x2235b023, 0x078e45f8, 0x69425b95, 0x4cf9ae4e,
+    0x9ce9bf66, 0xb9524abd, 0xd79e54d0, 0xf225a10b,
+    0x0a06680a, 0x2fbd9dd1, 0x417183bc, 0x64ca7667,
+    0x88e56f72, 0xad5e9aa9, 0xc39284c4, 0xe629711f,
+    0x1e0ab81e, 0x3bb14dc5, 0x557d53a8, 0x70c6a673,
+    0xa0d6b75b, 0x856d4280, 0xeba15ced, 0xce1aa936,
+    0x36396037, 0x138295ec, 0x7d4e8b81, 0x58f57e5a,
+    0xd882df20, 0xfd392afb, 0x93f53496, 0xb64ec14d,
+    0x4e6d084c, 0x6bd6fd97, 0x051ae3fa, 0x20a11621,
+    0xf0b10709, 0xd50af2d2, 0xbbc6ecbf, 0x9e7d1964,
+    0x665ed065, 0x43e525be, 0x2d293bd3, 0x0892ce08,
+    0x282a0fd6, 0x0d91fa0d, 0x635de460, 0x46e611bb,
+    0xbec5d8ba, 0x9b7e2d61, 0xf5b2330c, 0xd009c6d7,
+    0x0019d7ff, 0x25a22224, 0x4b6e3c49, 0x6ed5c992,
+    0x96f60093, 0xb34df548, 0xdd81eb25, 0xf83a1efe,
+    0x784dbf84, 0x5df64a5f, 0x333a5432, 0x1681a1e9,
+    0xeea268e8, 0xcb199d33, 0xa5d5835e, 0x806e7685,
+    0x507e67ad, 0x75c59276, 0x1b098c1b, 0x3eb279c0,
+    0xc691b0c1, 0xe32a451a, 0x8de65b77, 0xa85daeac,
+    0xcc97d8cb, 0xe92c2d10, 0x87e0337d, 0xa25bc6a6,
+    0x5a780fa7, 0x7fc3fa7c, 0x110fe411, 0x34b411ca,
+    0xe4a400e2, 0xc11ff539, 0xafd3eb54, 0x8a681e8f,
+    0x724bd78e, 0x57f02255, 0x393c3c38, 0x1c87c9e3,
+    0x9cf06899, 0xb94b9d42, 0xd787832f, 0xf23c76f4,
+    0x0a1fbff5, 0x2fa44a2e, 0x41685443, 0x64d3a198,
+    0xb4c3b0b0, 0x9178456b, 0xffb45b06, 0xda0faedd,
+    0x222c67dc, 0x07979207, 0x695b8c6a, 0x4ce079b1,
+    0x6c58b86f, 0x49e34db4, 0x272f53d9, 0x0294a602,
+    0xfab76f03, 0xdf0c9ad8, 0xb1c084b5, 0x947b716e,
+    0x446b6046, 0x61d0959d, 0x0f1c8bf0, 0x2aa77e2b,
+    0xd284b72a, 0xf73f42f1, 0x99f35c9c, 0xbc48a947,
+    0x3c3f083d, 0x1984fde6, 0x7748e38b, 0x52f31650,
+    0xaad0df51, 0x8f6b2a8a, 0xe1a734e7, 0xc41cc13c,
+    0x140cd014, 0x31b725cf, 0x5f7b3ba2, 0x7ac0ce79,
+    0x82e30778, 0xa758f2a3, 0xc994ecce, 0xec2f1915,
+  },
+};
+
+// Fold by 16, 32, 48 and 64 bytes
+static const uint64_t crc32c_fold[4][2] = {
+  { 0x00000000f20c0dfe, 0x000000014cd00bd6 },
+  { 0x00000001384aa63a, 0x00000000ba4fc28e },
+  { 0x000000001c291d04, 0x00000001d82c63da },
+  { 0x00000000740eef02, 0x000000009e4addf8 },
+};
@@ -0,0 +1,63 @@
+// © 2025 Unit Circle Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "frame.h"
+#include "crc32c.h"
+
+// Data is processed in chunks small enough to stay in cache between the
+// CRC and the COBS step.
+#define CHUNK 512u
+
+size_t uccomm_frame_encode(uint8_t* out, const uint8_t* in, size_t n) {
+  uint32_t crc = CRC32C_INIT;
+  cobs_enc_t e;
+  cobs_enc_begin(&e, out + 1);
+  while (n > 0) {
+    size_t k = n < CHUNK ? n : CHUNK;
+    crc = crc32c_update(crc, in, k);
+    cobs_enc_update(&e, in, k);
+    in += k;
+    n -= k;
+  }
+  const uint8_t c[4] = {
+    (uint8_t) crc, (uint8_t) (crc >> 8), (uint8_t) (crc >> 16), (uint8_t) (crc >> 24)
+  };
+  cobs_enc_update(&e, c, sizeof(c));
+  size_t nout = cobs_enc_end(&e);
+  out[0] = 0x00;
+  out[nout + 1] = 0x00;
+  return nout + 2;
+}
+
+ssize_t uccomm_frame_decode(uint8_t* out, const uint8_t* in, size_t n) {
+  while ((n > 0) && (in[0] == 0x00)) { in++;  n--; }
+  while ((n > 0) && (in[n - 1] == 0x00)) n--;
+
+  uint32_t crc = CRC32C_INIT;
+  cobs_dec_t d;
+  cobs_dec_begin(&d, out);
+  while (n > 0) {
+    size_t k = n < CHUNK ? n : CHUNK;
+    ssize_t m = cobs_dec_update(&d, in, k);
+    if (m < 0) return m;
+    crc = crc32c_update(crc, d.out - m, (size_t) m);
+    in += k;
+    n -= k;
+  }
+  ssize_t nout = cobs_dec_end(&d);
+  if (nout < 0) return nout;
+  // CRC over data and appended CRC gives a constant if there are no errors
+  if ((nout < 4) || (crc != CRC32C_OK_REM)) return -3;
+  return nout - 4;
+}
@@ -0,0 +1,49 @@
+// © 2025 Unit Circle Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include <sys/types.h>
+
+#include "cobs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Framing of packets as 0x00 COBS(data | crc32c) 0x00 with the CRC32C in
+// little endian order.  The CRC is computed while encoding/decoding so the
+// data is only walked once.
+
+// Size of an encoded frame including the CRC and both 0x00 delimiters
+#define UCCOMM_FRAME_ENC_SIZE(n_) (2u + COBS_ENC_SIZE((n_) + 4u))
+
+// Encode n bytes of in as a frame in out, returns the frame length.
+// To encode "inplace" place the input at the right end of a buffer of
+// UCCOMM_FRAME_ENC_SIZE(n) bytes with out at the start of the buffer.
+size_t uccomm_frame_encode(uint8_t* out, const uint8_t* in, size_t n);
+
+// Decode a frame, with or without its 0x00 delimiters, returns the length
+// of the data (the CRC is removed) or:
+//   -1 input contains 0x00 inside the frame
+//   -2 frame ended part way through a COBS block
+//   -3 frame too short or CRC check failed
+// Can be done "inplace" - out may be the same as in.
+ssize_t uccomm_frame_decode(uint8_t* out, const uint8_t* in, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
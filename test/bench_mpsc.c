@@ -0,0 +1,150 @@
+// © 2025 Unit Circle Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Contention benchmark - P producer threads send 64 byte records to one
+// consumer, through cb_mpsc_t and through cbq_t with a mutex around the
+// producer side.  Reports throughput and the time each producer spends in
+// reserve + fill + commit (including waiting for the lock).
+//
+//   make bench-mpsc
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "cb_mpsc.h"
+#include "cbq.h"
+
+#define RECORDS  (1u << 20)  // total, split over the producers
+#define REC_SIZE 64
+#define BUF_SIZE (64u * 1024u)
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+typedef struct {
+  bool mpsc;
+  cb_mpsc_t mq;
+  cbq_t q;
+  pthread_mutex_t lock;
+  size_t per_producer;
+} bench_t;
+
+typedef struct {
+  bench_t* b;
+  uint32_t* lat;  // ns per record
+} prod_t;
+
+static void* producer(void* arg) {
+  prod_t* p = arg;
+  bench_t* b = p->b;
+  for (size_t i = 0; i < b->per_producer; ) {
+    uint64_t t0 = now_ns();
+    uint8_t* r;
+    if (b->mpsc) {
+      r = cb_mpsc_reserve(&b->mq, REC_SIZE);
+      if (r != NULL) {
+        memset(r, (int) i, REC_SIZE);
+        cb_mpsc_commit(&b->mq, r, REC_SIZE);
+      }
+    }
+    else {
+      pthread_mutex_lock(&b->lock);
+      r = cbq_reserve(&b->q, REC_SIZE);
+      if (r != NULL) {
+        memset(r, (int) i, REC_SIZE);
+        cbq_commit(&b->q, REC_SIZE);
+      }
+      pthread_mutex_unlock(&b->lock);
+    }
+    if (r == NULL) {
+      sched_yield();  // full - not counted
+      continue;
+    }
+    p->lat[i++] = (uint32_t) (now_ns() - t0);
+  }
+  return NULL;
+}
+
+static void* consumer(void* arg) {
+  bench_t* b = arg;
+  volatile uint8_t sink = 0;
+  for (size_t i = 0; i < RECORDS; ) {
+    size_t n;
+    const uint8_t* r = b->mpsc ? cb_mpsc_peek(&b->mq, &n) : cbq_peek(&b->q, &n);
+    if (r == NULL) {
+      sched_yield();
+      continue;
+    }
+    sink = r[n - 1];
+    if (b->mpsc) cb_mpsc_release(&b->mq);
+    else cbq_release(&b->q);
+    i++;
+  }
+  (void) sink;
+  return NULL;
+}
+
+static int cmp_u32(const void* a, const void* b) {
+  uint32_t x = *(const uint32_t*) a;
+  uint32_t y = *(const uint32_t*) b;
+  return (x > y) - (x < y);
+}
+
+static void run(bool mpsc, unsigned np) {
+  static uint32_t buf[BUF_SIZE / 4];
+  static uint32_t lat[RECORDS];
+  static bench_t b;
+  b.mpsc = mpsc;
+  b.per_producer = RECORDS / np;
+  cb_mpsc_init(&b.mq, buf, sizeof(buf));
+  cbq_init(&b.q, buf, sizeof(buf));
+  pthread_mutex_init(&b.lock, NULL);
+
+  prod_t p[64];
+  pthread_t pt[64];
+  pthread_t ct;
+  uint64_t t0 = now_ns();
+  pthread_create(&ct, NULL, consumer, &b);
+  for (unsigned i = 0; i < np; i++) {
+    p[i] = (prod_t) { &b, &lat[i * b.per_producer] };
+    pthread_create(&pt[i], NULL, producer, &p[i]);
+  }
+  for (unsigned i = 0; i < np; i++) pthread_join(pt[i], NULL);
+  pthread_join(ct, NULL);
+  uint64_t t = now_ns() - t0;
+  pthread_mutex_destroy(&b.lock);
+
+  size_t n = b.per_producer * np;
+  qsort(lat, n, sizeof(lat[0]), cmp_u32);
+  printf("%-6s %2u producers: %7.2f Mrec/s  enqueue ns p50 %5u p99 %6u p99.9 %7u max %8u\n",
+         mpsc ? "mpsc" : "mutex", np, (double) n * 1e3 / (double) t,
+         lat[n / 2], lat[n * 99 / 100], lat[n * 999 / 1000], lat[n - 1]);
+}
+
+int main(int argc, char** argv) {
+  unsigned max_p = argc > 1 ? (unsigned) atoi(argv[1]) : 8;
+  if ((max_p < 1) || (max_p > 64)) max_p = 8;
+  for (unsigned np = 1; np <= max_p; np *= 2) {
+    run(false, np);
+    run(true, np);
+  }
+  return 0;
+}
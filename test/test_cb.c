@@ -0,0 +1,469 @@
+// © 2025 Unit Circle Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "cb.h"
+#include "cb_fd.h"
+#include "cb_mirror.h"
+#include "cb_mpsc.h"
+#include "cb_wait.h"
+#include "cbq.h"
+
+#define STRESS_BYTES (4u * 1000u * 1000u)
+
+// With CB_POW2 sizes must be a power of 2 and all of the buffer is usable
+#if defined(CB_POW2)
+#define SMALL 16
+#define LARGE 1024
+#define SLACK 0
+#else
+#define SMALL 17
+#define LARGE 1021
+#define SLACK 1
+#endif
+
+static uint8_t seq(size_t i) {
+  return (uint8_t) ((i * 7) % 251);
+}
+
+// Producer alternates cb_write and cb_space/cb_commit in random sized
+// pieces, consumer alternates cb_read and cb_peek/cb_skip and checks the
+// sequence arrives intact.
+static void* producer(void* arg) {
+  cb_t* cb = arg;
+  uint8_t tmp[300];
+  unsigned seed = 1;
+  for (size_t i = 0; i < STRESS_BYTES; ) {
+    size_t k = 1 + rand_r(&seed) % sizeof(tmp);
+    if (k > STRESS_BYTES - i) k = STRESS_BYTES - i;
+    if (i % 2 == 0) {
+      size_t avail = cb_write_avail(cb);
+      if (avail == 0) sched_yield();
+      if (k > avail) k = avail;
+      for (size_t j = 0; j < k; j++) tmp[j] = seq(i + j);
+      cb_write(cb, tmp, k);
+    }
+    else {
+      size_t avail = cb_space_avail(cb);
+      if (avail == 0) sched_yield();
+      if (k > avail) k = avail;
+      uint8_t* p = (uint8_t*) cb_space(cb);
+      for (size_t j = 0; j < k; j++) p[j] = seq(i + j);
+      cb_commit(cb, k);
+    }
+    i += k;
+  }
+  return NULL;
+}
+
+static void* consumer(void* arg) {
+  cb_t* cb = arg;
+  uint8_t tmp[300];
+  unsigned seed = 2;
+  size_t bad = 0;
+  for (size_t i = 0; i < STRESS_BYTES; ) {
+    size_t k = 1 + rand_r(&seed) % sizeof(tmp);
+    if (i % 2 == 0) {
+      size_t avail = cb_read_avail(cb);
+      if (avail == 0) sched_yield();
+      if (k > avail) k = avail;
+      cb_read(cb, tmp, k);
+    }
+    else {
+      size_t avail = cb_peek_avail(cb);
+      if (avail == 0) sched_yield();
+      if (k > avail) k = avail;
+      memcpy(tmp, cb_peek(cb), k);
+      cb_skip(cb, k);
+    }
+    for (size_t j = 0; j < k; j++) bad += tmp[j] != seq(i + j);
+    i += k;
+  }
+  return (void*) bad;
+}
+
+// Records of random length, each filled from the sequence at its index
+#define RECORDS 200000u
+
+static size_t rec_len(size_t i) {
+  return (i * 2654435761u) % 301;
+}
+
+static void* rec_producer(void* arg) {
+  cbq_t* q = arg;
+  for (size_t i = 0; i < RECORDS; ) {
+    size_t n = rec_len(i);
+    uint8_t* p = cbq_reserve(q, n + 10);
+    if (p == NULL) {
+      sched_yield();
+      continue;
+    }
+    for (size_t j = 0; j < n; j++) p[j] = seq(i + j);
+    cbq_commit(q, n);
+    i++;
+  }
+  return NULL;
+}
+
+static void* rec_consumer(void* arg) {
+  cbq_t* q = arg;
+  size_t bad = 0;
+  for (size_t i = 0; i < RECORDS; ) {
+    size_t n;
+    const uint8_t* p = cbq_peek(q, &n);
+    if (p == NULL) {
+      sched_yield();
+      continue;
+    }
+    bad += n != rec_len(i);
+    for (size_t j = 0; (j < n) && (n == rec_len(i)); j++) bad += p[j] != seq(i + j);
+    cbq_release(q);
+    i++;
+  }
+  return (void*) bad;
+}
+
+// Producer and consumer sleep in cb_wait_writable/readable instead of
+// spinning - the consumer waits for a full "message" of WAIT_MIN bytes.
+#define WAIT_MIN 64
+
+static void* wait_producer(void* arg) {
+  cb_wait_t* w = arg;
+  uint8_t tmp[100];
+  for (size_t i = 0; i < STRESS_BYTES; ) {
+    size_t k = sizeof(tmp);
+    if (k > STRESS_BYTES - i) k = STRESS_BYTES - i;
+    if (cb_wait_writable(w, k, 1000) != 0) return (void*) 1;
+    for (size_t j = 0; j < k; j++) tmp[j] = seq(i + j);
+    cb_write(w->cb, tmp, k);
+    cb_wait_notify_readable(w);
+    i += k;
+  }
+  return NULL;
+}
+
+static void* wait_consumer(void* arg) {
+  cb_wait_t* w = arg;
+  uint8_t tmp[WAIT_MIN];
+  size_t bad = 0;
+  for (size_t i = 0; i < STRESS_BYTES; i += WAIT_MIN) {
+    if (cb_wait_readable(w, WAIT_MIN, 1000) != 0) return (void*) STRESS_BYTES;
+    cb_read(w->cb, tmp, WAIT_MIN);
+    cb_wait_notify_writable(w);
+    for (size_t j = 0; j < WAIT_MIN; j++) bad += tmp[j] != seq(i + j);
+  }
+  return (void*) bad;
+}
+
+// Several producers into one cb_mpsc_t - each record carries its producer
+// and index, which the consumer checks arrive in order per producer
+#define PRODUCERS 4
+
+typedef struct {
+  cb_mpsc_t* q;
+  uint8_t id;
+} mpsc_arg_t;
+
+static void* mpsc_producer(void* arg) {
+  mpsc_arg_t* a = arg;
+  for (uint32_t i = 0; i < RECORDS / PRODUCERS; ) {
+    size_t n = rec_len(i);
+    uint8_t* p = cb_mpsc_reserve(a->q, 5 + n + 10);
+    if (p == NULL) {
+      sched_yield();
+      continue;
+    }
+    p[0] = a->id;
+    memcpy(p + 1, &i, 4);
+    for (size_t j = 0; j < n; j++) p[5 + j] = seq(i + j);
+    cb_mpsc_commit(a->q, p, 5 + n);
+    i++;
+  }
+  return NULL;
+}
+
+static void* mpsc_consumer(void* arg) {
+  cb_mpsc_t* q = arg;
+  uint32_t next[PRODUCERS] = { 0 };
+  size_t bad = 0;
+  for (size_t k = 0; k < RECORDS / PRODUCERS * PRODUCERS; ) {
+    size_t n;
+    const uint8_t* p = cb_mpsc_peek(q, &n);
+    if (p == NULL) {
+      sched_yield();
+      continue;
+    }
+    uint32_t i;
+    memcpy(&i, p + 1, 4);
+    if ((n < 5) || (p[0] >= PRODUCERS) || (i != next[p[0]]) || (n != 5 + rec_len(i))) {
+      bad++;
+    }
+    else {
+      next[p[0]]++;
+      for (size_t j = 0; j < n - 5; j++) bad += p[5 + j] != seq(i + j);
+    }
+    cb_mpsc_release(q);
+    k++;
+  }
+  return (void*) bad;
+}
+
+int main(void) {
+  int failed = 0;
+
+  {
+    // Fill and drain across every wrap position
+    static uint8_t b[SMALL];
+    static uint8_t in[32];
+    static uint8_t out[32];
+    cb_t cb;
+    cb_init(&cb, b, sizeof(b));
+    for (size_t i = 0; i < sizeof(in); i++) in[i] = i + 1;
+#if defined(CB_POW2)
+    // Indexes wrap at SIZE_MAX part way through
+    atomic_store(&cb.read, SIZE_MAX - 300);
+    atomic_store(&cb.write, SIZE_MAX - 300);
+#endif
+    for (int i = 0; i < 200; i++) {
+      size_t n = i % (sizeof(b) + 1 - SLACK);
+      if ((cb_read_avail(&cb) != 0) || (cb_write_avail(&cb) != sizeof(b) - SLACK)) {
+        printf("cb empty test %d - failed\n", i+1);
+        failed++;
+        break;
+      }
+      cb_write(&cb, in, n);
+      size_t peek = cb_peek_avail(&cb);
+      if ((cb_read_avail(&cb) != n) || (cb_write_avail(&cb) != sizeof(b) - SLACK - n) ||
+          (peek > n) || (memcmp(cb_peek(&cb), in, peek) != 0)) {
+        printf("cb avail test %d - failed\n", i+1);
+        failed++;
+        break;
+      }
+      struct iovec iov[2];
+      struct iovec sp[2];
+      if ((cb_peek_iov(&cb, iov) != n) || (iov[0].iov_len != peek) ||
+          (iov[0].iov_len + iov[1].iov_len != n) ||
+          (memcmp(iov[0].iov_base, in, iov[0].iov_len) != 0) ||
+          (memcmp(iov[1].iov_base, in + iov[0].iov_len, iov[1].iov_len) != 0) ||
+          (cb_space_iov(&cb, sp) != cb_write_avail(&cb)) ||
+          (sp[0].iov_base != cb_space(&cb)) || (sp[0].iov_len != cb_space_avail(&cb))) {
+        printf("cb iov test %d - failed\n", i+1);
+        failed++;
+        break;
+      }
+      cb_read(&cb, out, n);
+      if (memcmp(out, in, n) != 0) {
+        printf("cb read test %d - failed\n", i+1);
+        failed++;
+        break;
+      }
+      // Move the start point
+      cb_write(&cb, in, 1 + i % 5);
+      cb_skip(&cb, 1 + i % 5);
+    }
+  }
+
+  {
+    static uint8_t b[LARGE];
+    cb_t cb;
+    cb_init(&cb, b, sizeof(b));
+    pthread_t p;
+    pthread_t c;
+    void* bad;
+    pthread_create(&c, NULL, consumer, &cb);
+    pthread_create(&p, NULL, producer, &cb);
+    pthread_join(p, NULL);
+    pthread_join(c, &bad);
+    if (bad != NULL) {
+      printf("cb spsc test - failed: %zu bytes wrong\n", (size_t) bad);
+      failed++;
+    }
+  }
+
+  {
+    // Record queue - fill until full, then drain, across the wrap
+    static uint32_t b[256];
+    cbq_t q;
+    cbq_init(&q, b, sizeof(b));
+    size_t head = 0;
+    size_t tail = 0;
+    for (int i = 0; (i < 2000) && (failed == 0); i++) {
+      if (i % 3 != 2) {
+        size_t n = rec_len(head);
+        uint8_t* p = cbq_reserve(&q, n);
+        if (p != NULL) {
+          for (size_t j = 0; j < n; j++) p[j] = seq(head + j);
+          cbq_commit(&q, n);
+          head++;
+        }
+      }
+      else {
+        size_t n;
+        const uint8_t* p = cbq_peek(&q, &n);
+        if ((p == NULL) != (head == tail)) {
+          printf("cbq peek test %d - failed\n", i+1);
+          failed++;
+        }
+        if (p == NULL) continue;
+        for (size_t j = 0; j < n; j++) {
+          if ((n != rec_len(tail)) || (p[j] != seq(tail + j))) {
+            printf("cbq record test %d - failed\n", i+1);
+            failed++;
+            break;
+          }
+        }
+        cbq_release(&q);
+        tail++;
+      }
+    }
+  }
+
+  {
+    static uint32_t b[1024];
+    cbq_t q;
+    cbq_init(&q, b, sizeof(b));
+    pthread_t p;
+    pthread_t c;
+    void* bad;
+    pthread_create(&c, NULL, rec_consumer, &q);
+    pthread_create(&p, NULL, rec_producer, &q);
+    pthread_join(p, NULL);
+    pthread_join(c, &bad);
+    if (bad != NULL) {
+      printf("cbq spsc test - failed: %zu bytes wrong\n", (size_t) bad);
+      failed++;
+    }
+  }
+
+  {
+    static uint8_t b[LARGE];
+    cb_t cb;
+    cb_wait_t w;
+    cb_init(&cb, b, sizeof(b));
+    cb_wait_init(&w, &cb);
+    errno = 0;
+    if ((cb_wait_readable(&w, 1, 10) != -1) || (errno != ETIMEDOUT)) {
+      printf("cb wait timeout test - failed\n");
+      failed++;
+    }
+    if (cb_wait_writable(&w, sizeof(b) - SLACK, 10) != 0) {
+      printf("cb wait writable test - failed\n");
+      failed++;
+    }
+    pthread_t p;
+    pthread_t c;
+    void* bad_p;
+    void* bad_c;
+    pthread_create(&c, NULL, wait_consumer, &w);
+    pthread_create(&p, NULL, wait_producer, &w);
+    pthread_join(p, &bad_p);
+    pthread_join(c, &bad_c);
+    if ((bad_p != NULL) || (bad_c != NULL)) {
+      printf("cb wait test - failed: %zu bytes wrong\n", (size_t) bad_c);
+      failed++;
+    }
+  }
+
+  {
+    static uint32_t b[1024];
+    cb_mpsc_t q;
+    cb_mpsc_init(&q, b, sizeof(b));
+    mpsc_arg_t a[PRODUCERS];
+    pthread_t p[PRODUCERS];
+    pthread_t c;
+    void* bad;
+    pthread_create(&c, NULL, mpsc_consumer, &q);
+    for (int i = 0; i < PRODUCERS; i++) {
+      a[i] = (mpsc_arg_t) { &q, (uint8_t) i };
+      pthread_create(&p[i], NULL, mpsc_producer, &a[i]);
+    }
+    for (int i = 0; i < PRODUCERS; i++) pthread_join(p[i], NULL);
+    pthread_join(c, &bad);
+    if (bad != NULL) {
+      printf("cb mpsc test - failed: %zu records wrong\n", (size_t) bad);
+      failed++;
+    }
+  }
+
+  {
+    // fd transfers through a pipe, at every offset so the wrap is crossed
+    static uint8_t b[SMALL];
+    uint8_t in[SMALL];
+    uint8_t out[SMALL];
+    for (size_t i = 0; i < sizeof(in); i++) in[i] = seq(i);
+    int fds[2];
+    cb_t cb;
+    cb_init(&cb, b, sizeof(b));
+    if (pipe(fds) != 0) {
+      printf("cb fd pipe - failed\n");
+      failed++;
+    }
+    for (size_t i = 0; (i < 3 * sizeof(b)) && (failed == 0); i++) {
+      size_t n = sizeof(b) - SLACK;
+      cb_write(&cb, in, i % sizeof(b) / 2);  // move the indexes along
+      cb_skip(&cb, i % sizeof(b) / 2);
+      if ((write(fds[1], in, n) != (ssize_t) n) ||
+          (cb_fill_from_fd(&cb, fds[0]) != (ssize_t) n) ||
+          (cb_read_avail(&cb) != n) ||
+          (cb_drain_to_fd(&cb, fds[1]) != (ssize_t) n) ||
+          (cb_read_avail(&cb) != 0) ||
+          (read(fds[0], out, n) != (ssize_t) n) ||
+          (memcmp(in, out, n) != 0)) {
+        printf("cb fd test %zu - failed\n", i+1);
+        failed++;
+      }
+    }
+    close(fds[0]);
+    close(fds[1]);
+  }
+
+#if defined(__linux__)
+  {
+    // Mirrored - everything queued can be peeked in one go, and data
+    // written across the wrap via cb_space is contiguous
+    cb_t cb;
+    static uint8_t in[4096];
+    for (size_t i = 0; i < sizeof(in); i++) in[i] = seq(i);
+    if (cb_mirror_init(&cb, 4096) != 0) {
+      printf("cb mirror init - failed\n");
+      failed++;
+    }
+    for (int i = 0; (i < 100) && (failed == 0); i++) {
+      size_t n = (i * 997) % (cb.n + 1 - SLACK);
+      cb_write(&cb, in, n / 2);
+      if (cb_space_avail(&cb) != cb_write_avail(&cb)) {
+        printf("cb mirror space test %d - failed\n", i+1);
+        failed++;
+      }
+      memcpy((void*) cb_space(&cb), in + n / 2, n - n / 2);
+      cb_commit(&cb, n - n / 2);
+      if ((cb_peek_avail(&cb) != n) || (memcmp(cb_peek(&cb), in, n) != 0)) {
+        printf("cb mirror peek test %d - failed\n", i+1);
+        failed++;
+      }
+      cb_skip(&cb, n);
+    }
+    cb_mirror_free(&cb);
+  }
+#endif
+
+  if (failed == 0) printf("cb test - passed\n");
+  return failed != 0;
+}
@@ -561,6 +561,128 @@ TEST test_append(void) {
   PASS();
 }
 
+TEST test_seq(void) {
+  // 1, "ab", [1, [2]], {_ "a": 1}, 24(h'01'), 55799(true), h'0102' (truncated)
+  uint8_t b[40];
+  size_t  n = dechex(sizeof(b), b, "01" "626162" "820181" "02" "BF616101FF"
+                                    "D8184101" "D9D9F7F5" "420102");
+  cbor_seq_t q;
+  cbor_seq_item_t items[3];
+  size_t count;
+  cbor_error_t e;
+
+  cbor_seq_init(&q, b, n - 1);
+  e = cbor_seq_read(&q, items, 3, &count);
+  ASSERT_EQ_FMT(CBOR_ERROR_NONE, e, "%d");
+  ASSERT_EQ_FMT((size_t) 3, count, "%zu");
+  ASSERT_EQ(b + 0, items[0].b);
+  ASSERT_EQ_FMT((size_t) 1, items[0].n, "%zu");
+  ASSERT_EQ_FMT((size_t) 3, items[1].n, "%zu");
+  ASSERT_EQ_FMT((size_t) 4, items[2].n, "%zu");
+
+  e = cbor_seq_read(&q, items, 3, &count);
+  ASSERT_EQ_FMT(CBOR_ERROR_NONE, e, "%d");
+  ASSERT_EQ_FMT((size_t) 3, count, "%zu");
+  ASSERT_EQ_FMT((size_t) 5, items[0].n, "%zu");
+  ASSERT_EQ_FMT((size_t) 4, items[1].n, "%zu");
+  ASSERT_EQ_FMT((size_t) 4, items[2].n, "%zu");
+
+  // Each item can be decoded in full
+  cbor_stream_t s;
+  bool v;
+  cbor_init(&s, items[2].b, items[2].n);
+  ASSERT_EQ_FMT(CBOR_ERROR_NONE, cbor_read_bool(&s, &v), "%d");
+  ASSERT(v);
+
+  // Truncated last item - left for when more data arrives
+  uint8_t* last = q.b;
+  e = cbor_seq_read(&q, items, 3, &count);
+  ASSERT_EQ_FMT(CBOR_ERROR_END_OF_STREAM, e, "%d");
+  ASSERT_EQ_FMT((size_t) 0, count, "%zu");
+  ASSERT_EQ(last, q.b);
+
+  cbor_seq_init(&q, last, 3);
+  e = cbor_seq_read(&q, items, 3, &count);
+  ASSERT_EQ_FMT(CBOR_ERROR_NONE, e, "%d");
+  ASSERT_EQ_FMT((size_t) 1, count, "%zu");
+  ASSERT_EQ_FMT((size_t) 0, q.n, "%zu");
+
+  // Malformed items
+  struct {
+    const char* encoded;
+    cbor_error_t error;
+  } bad[] = {
+    { "FF",             CBOR_ERROR_UNEXPECTED_BREAK },
+    { "1C",             CBOR_ERROR_INVALID_AI },
+    { "F800",           CBOR_ERROR_BAD_SIMPLE_VALUE },
+    { "BF01FF",         CBOR_ERROR_MAP_LENGTH },
+    { "5F0101FF",       CBOR_ERROR_INDEF_MISMATCH },
+    { "9BFFFFFFFFFFFFFFFF", CBOR_ERROR_END_OF_STREAM },
+    { "818181818181",   CBOR_ERROR_RECURSION },
+  };
+  for (size_t i = 0; i < sizeof(bad)/sizeof(*bad); i++) {
+    n = dechex(sizeof(b), b, bad[i].encoded);
+    cbor_seq_init(&q, b, n);
+    e = cbor_seq_read(&q, items, 3, &count);
+    ASSERT_EQ_FMT(bad[i].error, e, "%d");
+    ASSERT_EQ_FMT((size_t) 0, count, "%zu");
+  }
+  PASS();
+}
+
+TEST test_skip(void) {
+  const char* items[] = {
+    "1B0000000100000000",
+    "7F626162FF",
+    "A3616101616282F5F6616383F93C00FA47C35000FB3FF199999999999A",
+    "9F8201A0BFFFC1F93C00FF",
+    "C48221196AB3",
+    "D9D9F7D818450102030405",
+  };
+
+  for (size_t i = 0; i < sizeof(items)/sizeof(*items); i++) {
+    uint8_t b[40];
+    size_t n = dechex(sizeof(b), b, items[i]);
+    for (int mode = CBOR_SKIP_TRUSTED; mode <= CBOR_SKIP_STRICT; mode++) {
+      cbor_stream_t s;
+      cbor_init(&s, b, n);
+      ASSERT_EQ_FMT(CBOR_ERROR_NONE, cbor_skip_item(&s, mode), "%d");
+      ASSERT_EQ_FMT((size_t) 0, s.n, "%zu");
+    }
+  }
+
+  // Invalid UTF-8 is only detected when strict
+  uint8_t b[10];
+  size_t n = dechex(sizeof(b), b, "8262C328F5");
+  cbor_stream_t s;
+  cbor_init(&s, b, n);
+  ASSERT_EQ_FMT(CBOR_ERROR_NONE, cbor_skip_item(&s, CBOR_SKIP_TRUSTED), "%d");
+  ASSERT_EQ_FMT((size_t) 0, s.n, "%zu");
+  cbor_init(&s, b, n);
+  ASSERT_EQ_FMT(CBOR_ERROR_INVALID_UTF8, cbor_skip_item(&s, CBOR_SKIP_STRICT), "%d");
+
+  // A break straight after the self describe marker is only detected when
+  // strict - as for cbor_read_any
+  n = dechex(sizeof(b), b, "9FD9D9F7FF");
+  cbor_init(&s, b, n);
+  ASSERT_EQ_FMT(CBOR_ERROR_NONE, cbor_skip_item(&s, CBOR_SKIP_TRUSTED), "%d");
+  cbor_init(&s, b, n);
+  ASSERT_EQ_FMT(CBOR_ERROR_UNEXPECTED_BREAK, cbor_skip_item(&s, CBOR_SKIP_STRICT), "%d");
+  cbor_value_t v_any;
+  cbor_init(&s, b, n);
+  ASSERT_EQ_FMT(CBOR_ERROR_UNEXPECTED_BREAK, cbor_read_any(&s, &v_any), "%d");
+
+  // Map lookups skip the values of other keys
+  n = dechex(sizeof(b), b, "A2616182F5F6616207");
+  cbor_stream_t m;
+  size_t m_n;
+  uint64_t v;
+  cbor_init(&s, b, n);
+  ASSERT_EQ_FMT(CBOR_ERROR_NONE, cbor_read_map(&s, &m, &m_n), "%d");
+  ASSERT_EQ_FMT(CBOR_ERROR_NONE, cbor_get_uint64(&m, m_n, "b", &v), "%d");
+  ASSERT_EQ_FMT((uint64_t) 7, v, "%llu");
+  PASS();
+}
 
 SUITE(the_suite) {
   RUN_TEST(test_int64);
@@ -570,6 +692,8 @@ SUITE(the_suite) {
   RUN_TEST(test_bytes);
   RUN_TEST(test_text);
   RUN_TEST(test_append);
+  RUN_TEST(test_seq);
+  RUN_TEST(test_skip);
 }
 
 GREATEST_MAIN_DEFS();
@@ -13,8 +13,11 @@
 // limitations under the License.
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
 #include <string.h>
 #include "cobs.h"
+#include "cobs_mt.h"
 
 uint8_t in1[] = { 0x00 };
 uint8_t in2[] = { 0x45 };
@@ -253,6 +256,79 @@ struct {
   {sizeof(dec2), dec2, -2},
 };
 
+// Original byte at a time encoder - reference for the optimized versions
+size_t ref_enc(uint8_t* out, const uint8_t* in, size_t n) {
+  size_t nout = 0;
+  bool last_max = false;
+  out[0] = 1;
+  while (n-- > 0) {
+    last_max = false;
+    uint8_t v = *in++;
+    if (v == 0) {
+      nout += out[0];
+      out += out[0];
+      out[0] = 1;
+    }
+    else {
+      out[out[0]++] = v;
+      if (out[0] == 255) {
+        nout += out[0];
+        out += out[0];
+        out[0] = 1;
+        last_max = true;
+      }
+    }
+  }
+  if (!last_max) {
+    nout += out[0];
+  }
+  return nout;
+}
+
+// Original byte at a time decoder
+ssize_t ref_dec(uint8_t* out, const uint8_t* in, size_t n) {
+  bool out0 = false;
+  uint8_t code = 0;
+  size_t nout = 0;
+  if (memchr(in, 0x00, n) != NULL) return -1;
+  while (n > 0) {
+    if (code == 0) {
+      if (out0) { *out++ = 0x00; nout++; }
+      code = *in++;  n--;
+      out0 = code != 255;
+      code--;
+    }
+    else {
+      *out++ = *in++;
+      nout++; n--;
+      code--;
+    }
+  }
+  if (code >  0) return -2;
+  return nout;
+}
+
+// Random data with roughly one 0x00 every `sparse` bytes
+void fill_random(uint8_t* b, size_t n, int sparse) {
+  for (size_t j = 0; j < n; j++) {
+    b[j] = (rand() % sparse) == 0 ? 0x00 : (rand() % 255) + 1;
+  }
+}
+
+// Frames collected by the stream decoder callback
+struct {
+  size_t  count;
+  ssize_t n[64];
+  uint8_t b[64][600];
+} frames;
+
+void on_frame(void* ctx, uint8_t* b, ssize_t n) {
+  (void) ctx;
+  frames.n[frames.count] = n;
+  if (n > 0) memmove(frames.b[frames.count], b, n);
+  frames.count++;
+}
+
 void dumphex(uint8_t* b, size_t n) {
   for (int j = 0; j < n; j++) {
     printf(" %02x", b[j]);
@@ -330,5 +406,432 @@ int main(void) {
     printf("dec test case %d - passed\n", i+1);
   }
 
+  {
+    static uint8_t in[2000];
+    static uint8_t ref[2100];
+    static uint8_t out[2100];
+    const int sparse[] = { 1, 2, 16, 300, 100000 };
+    int failed = 0;
+    srand(1);
+    for (int i = 0; i < 2000; i++) {
+      size_t n = rand() % sizeof(in);
+      fill_random(in, n, sparse[i % 5]);
+      size_t nref = ref_enc(ref, in, n);
+
+      size_t nn = cobs_enc_size(n) - n;
+      memmove(out + nn, in, n);
+      size_t no = cobs_enc(out, out + nn, n);
+      if ((no != nref) || (memcmp(out, ref, nref) != 0)) {
+        printf("enc ref test %d - failed: len %zu\n", i+1, n);
+        failed++;
+      }
+    }
+    if (failed == 0) printf("enc ref test - passed\n");
+  }
+
+  {
+    static uint8_t in[2100];
+    static uint8_t ref[2100];
+    static uint8_t out[2100];
+    const int sparse[] = { 1, 2, 16, 300, 100000 };
+    int failed = 0;
+    srand(2);
+    for (int i = 0; i < 4000; i++) {
+      size_t n = rand() % 2000;
+      if (i % 2 == 0) {
+        // Valid encoding, decoded inplace
+        fill_random(ref, n, sparse[i % 5]);
+        n = cobs_enc(in, ref, n);
+      }
+      else {
+        // Mostly invalid or truncated input
+        fill_random(in, n, sparse[i % 5] * 50);
+      }
+      ssize_t nref = ref_dec(ref, in, n);
+      memmove(out, in, n);
+      ssize_t no = cobs_dec(out, out, n);
+      if ((no != nref) || ((nref > 0) && (memcmp(out, ref, nref) != 0))) {
+        printf("dec ref test %d - failed: nout (%zd) != expected (%zd)\n",
+            i+1, no, nref);
+        failed++;
+      }
+    }
+    if (failed == 0) printf("dec ref test - passed\n");
+  }
+
+  {
+    // Stream of frames: random lengths, one too long, one truncated and
+    // extra delimiters, fed in random sized chunks
+    static uint8_t data[40][600];
+    static size_t  data_n[40];
+    static uint8_t stream[40 * 610];
+    static uint8_t fb[512];
+    size_t n = 0;
+    int failed = 0;
+    srand(3);
+    stream[n++] = 0x00;
+    for (int i = 0; i < 40; i++) {
+      data_n[i] = i == 7 ? 600 : rand() % 512;
+      fill_random(data[i], data_n[i], 1 + i % 20);
+      n += cobs_enc(stream + n, data[i], data_n[i]);
+      if (i == 12) n -= 3;  // drop end of frame 13
+      stream[n++] = 0x00;
+      if (i % 3 == 0) stream[n++] = 0x00;
+    }
+
+    cobs_stream_dec_t d;
+    cobs_stream_dec_init(&d, fb, sizeof(fb), on_frame, NULL);
+    frames.count = 0;
+    for (size_t i = 0; i < n; ) {
+      size_t chunk = 1 + rand() % 700;
+      if (chunk > n - i) chunk = n - i;
+      cobs_stream_dec(&d, stream + i, chunk);
+      i += chunk;
+    }
+
+    if (frames.count != 40) {
+      printf("stream dec test - failed: frames (%zu) != 40\n", frames.count);
+      failed++;
+    }
+    for (int i = 0; (i < 40) && (failed == 0); i++) {
+      ssize_t expected = i == 7 ? -3 : data_n[i];
+      if ((i == 12) && (data_n[i] > 3)) expected = -2;
+      if ((frames.n[i] != expected) ||
+          ((expected > 0) && (memcmp(frames.b[i], data[i], expected) != 0))) {
+        printf("stream dec test frame %d - failed: n (%zd) != expected (%zd)\n",
+            i+1, frames.n[i], expected);
+        failed++;
+      }
+    }
+    if (failed == 0) printf("stream dec test - passed\n");
+  }
+
+  {
+    // Random input and output chunk sizes must give the cobs_enc output
+    static uint8_t in[3000];
+    static uint8_t ref[3100];
+    static uint8_t out[3100];
+    const int sparse[] = { 1, 2, 16, 300, 100000 };
+    int failed = 0;
+    cobs_stream_enc_t e;
+    cobs_stream_enc_init(&e);
+    srand(4);
+    for (int i = 0; i < 1000; i++) {
+      size_t n = i < 600 ? i : rand() % sizeof(in);
+      fill_random(in, n, sparse[i % 5]);
+      size_t nref = cobs_enc(ref, in, n);
+
+      size_t no = 0;
+      size_t ni = 0;
+      while (ni < n) {
+        size_t k_in = 1 + rand() % 300;
+        size_t k_out = rand() % 300;
+        if (k_in > n - ni) k_in = n - ni;
+        size_t used;
+        no += cobs_stream_enc(&e, out + no, k_out, in + ni, k_in, &used);
+        ni += used;
+      }
+      size_t k;
+      while ((k = cobs_stream_enc_end(&e, out + no, 1 + rand() % 300)) > 0) {
+        no += k;
+      }
+      if ((no != nref) || (memcmp(out, ref, nref) != 0)) {
+        printf("stream enc test %d - failed: len %zu\n", i+1, n);
+        failed++;
+      }
+    }
+    if (failed == 0) printf("stream enc test - passed\n");
+  }
+
+  {
+    // Incremental encode/decode in random pieces must match cobs_enc/dec
+    static uint8_t in[2000];
+    static uint8_t ref[2100];
+    static uint8_t out[2100];
+    const int sparse[] = { 1, 2, 16, 300, 100000 };
+    int failed = 0;
+    srand(6);
+    for (int i = 0; i < 2000; i++) {
+      size_t n = i < 600 ? i : rand() % sizeof(in);
+      fill_random(in, n, sparse[i % 5]);
+      size_t nref = cobs_enc(ref, in, n);
+
+      cobs_enc_t e;
+      cobs_enc_begin(&e, out);
+      for (size_t j = 0; j < n; ) {
+        size_t k = rand() % 300;
+        if (k > n - j) k = n - j;
+        cobs_enc_update(&e, in + j, k);
+        j += k;
+      }
+      size_t no = cobs_enc_end(&e);
+      if ((no != nref) || (memcmp(out, ref, nref) != 0)) {
+        printf("incremental enc test %d - failed: len %zu\n", i+1, n);
+        failed++;
+      }
+
+      if (i % 2 == 1) {
+        // Mostly invalid or truncated input
+        fill_random(ref, nref, sparse[i % 5] * 50);
+      }
+      ssize_t nd_ref = cobs_dec(in, ref, nref);
+      cobs_dec_t d;
+      cobs_dec_begin(&d, out);
+      ssize_t nd = 0;
+      for (size_t j = 0; (j < nref) && (nd >= 0); ) {
+        size_t k = rand() % 300;
+        if (k > nref - j) k = nref - j;
+        nd = cobs_dec_update(&d, ref + j, k);
+        j += k;
+      }
+      if (nd >= 0) nd = cobs_dec_end(&d);
+      if ((nd != nd_ref) || ((nd > 0) && (memcmp(out, in, nd) != 0))) {
+        printf("incremental dec test %d - failed: nout (%zd) != expected (%zd)\n",
+            i+1, nd, nd_ref);
+        failed++;
+      }
+    }
+    if (failed == 0) printf("incremental test - passed\n");
+  }
+
+  {
+    // Scatter-gather encode must match cobs_enc of the concatenation
+    static uint8_t in[2000];
+    static uint8_t ref[2100];
+    static uint8_t out[2100];
+    const int sparse[] = { 1, 2, 16, 300, 100000 };
+    int failed = 0;
+    srand(8);
+    for (int i = 0; i < 2000; i++) {
+      size_t n = i < 600 ? i : rand() % sizeof(in);
+      fill_random(in, n, sparse[i % 5]);
+      size_t nref = cobs_enc(ref, in, n);
+
+      struct iovec iov[8];
+      int iovcnt = 0;
+      for (size_t j = 0; (j < n) || (iovcnt == 0); iovcnt++) {
+        size_t k = iovcnt == 7 ? n - j : rand() % 300;
+        if (k > n - j) k = n - j;
+        iov[iovcnt].iov_base = in + j;
+        iov[iovcnt].iov_len = k;
+        j += k;
+      }
+      size_t no = cobs_encv(out, iov, iovcnt);
+      if ((no != nref) || (no > cobs_encv_size(iov, iovcnt)) ||
+          (memcmp(out, ref, nref) != 0)) {
+        printf("encv test %d - failed: len %zu\n", i+1, n);
+        failed++;
+      }
+    }
+    if (failed == 0) printf("encv test - passed\n");
+  }
+
+  {
+    // Batch decode of a capture - random frames, some truncated, extra
+    // delimiters and a partial frame at the end.  Checked against cobs_dec
+    // of each frame, single threaded and threaded, and with a small table.
+    static uint8_t data[600];
+    static uint8_t cap[1000 * 610];
+    static uint8_t b[1000 * 610];
+    static uint8_t ref[1000][600];
+    static ssize_t ref_n[1000];
+    static size_t  ref_off[1000];
+    static cobs_frame_t f[1000];
+    int failed = 0;
+    srand(7);
+    size_t n = 0;
+    size_t nframes = 0;
+    size_t n_complete = 0;
+    for (int i = 0; i < 1000; i++) {
+      if (i % 7 == 0) cap[n++] = 0x00;
+      size_t k = rand() % 600;
+      fill_random(data, k, 1 + i % 20);
+      size_t ne = cobs_enc(cap + n, data, k);
+      if (i % 50 == 3) ne -= ne > 2 ? 2 : 0;  // truncate
+      if (i < 999) {
+        ref_off[nframes] = n;
+        ref_n[nframes] = cobs_dec(ref[nframes], cap + n, ne);
+        nframes++;
+      }
+      n += ne;
+      if (i < 999) cap[n++] = 0x00;  // last frame is partial
+      if (i == 998) n_complete = n;
+    }
+
+    const struct { unsigned threads; size_t nf; bool inplace; } cases[] = {
+      { 0, 1000, true }, { 0, 100, true }, { 4, 1000, true }, { 4, 100, true },
+      { 4, 100, false },
+    };
+    for (int t = 0; t < (sizeof(cases)/sizeof(*cases)); t++) {
+      memcpy(b, cap, n);
+      const uint8_t* in = cases[t].inplace ? b : cap;
+      size_t pos = 0;
+      size_t got = 0;
+      while (true) {
+        size_t used;
+        size_t nfr = cobs_dec_batch_mt(b + pos, in + pos, n - pos, f,
+                                       cases[t].nf, &used, cases[t].threads);
+        if (nfr == 0) break;
+        for (size_t j = 0; (j < nfr) && (got < nframes); j++, got++) {
+          if ((pos + f[j].off != ref_off[got]) || (f[j].n != ref_n[got]) ||
+              ((f[j].n > 0) && (memcmp(b + pos + f[j].off, ref[got], f[j].n) != 0))) {
+            printf("batch dec test %d frame %zu - failed: n (%zd) != expected (%zd)\n",
+                t+1, got+1, f[j].n, ref_n[got]);
+            failed++;
+            break;
+          }
+        }
+        pos += used;
+      }
+      if ((got != nframes) || (pos != n_complete)) {
+        printf("batch dec test %d - failed: frames (%zu) != %zu, used (%zu) != %zu\n",
+            t+1, got, nframes, pos, n_complete);
+        failed++;
+      }
+    }
+
+    // Inplace with tables that fill part way through the buffer (and at
+    // the end of a thread's part) - the threaded decode must give the
+    // same frames and *used, and leave the same bytes, as single threaded
+    static uint8_t b1[1000 * 610];
+    static cobs_frame_t f1[1000];
+    for (size_t nf = 1; nf <= 1000; nf++) {
+      memcpy(b, cap, n);
+      memcpy(b1, cap, n);
+      size_t used;
+      size_t used1;
+      size_t nfr = cobs_dec_batch_mt(b, b, n, f, nf, &used, 4);
+      size_t nfr1 = cobs_dec_batch(b1, b1, n, f1, nf, &used1);
+      if ((nfr != nfr1) || (used != used1) || (memcmp(b, b1, n) != 0) ||
+          (memcmp(f, f1, nfr * sizeof(*f)) != 0)) {
+        printf("batch dec inplace test nf %zu - failed: frames (%zu) != %zu, used (%zu) != %zu\n",
+            nf, nfr, nfr1, used, used1);
+        failed++;
+      }
+    }
+
+    // No delimiter at all, at and above the size that is split over threads
+    const size_t sizes[] = { 64 * 1024, 100000 };
+    for (int t = 0; t < (sizeof(sizes)/sizeof(*sizes)); t++) {
+      memset(cap, 0x05, sizes[t]);
+      size_t used = 1;
+      size_t nfr = cobs_dec_batch_mt(b, cap, sizes[t], f, 1000, &used, 4);
+      if ((nfr != 0) || (used != 0)) {
+        printf("batch dec no delimiter test %d - failed: frames (%zu), used (%zu)\n",
+            t+1, nfr, used);
+        failed++;
+      }
+    }
+    if (failed == 0) printf("batch dec test - passed\n");
+  }
+
+  {
+    // COBS/ZPE vectors from src-python/cobs.py enc_zpe
+    static const struct {
+      const char* in;
+      const char* enc;
+    } zpe_tests[] = {
+      { "",                                 "01" },
+      { "00",                               "e1" },
+      { "0000",                             "e101" },
+      { "000000",                           "e1e1" },
+      { "11000022",                         "e2110222" },
+      { "4500002c4c79000040064f37",         "e245e42c4c790540064f37" },
+      { "01000000020000000003000000000400", "e20101e202e1e203e1e204" },
+    };
+    static uint8_t in[300];
+    static uint8_t enc[300];
+    static uint8_t out[600];
+    int failed = 0;
+    for (int i = 0; i < (sizeof(zpe_tests)/sizeof(*zpe_tests)) + 4; i++) {
+      size_t n = 0;
+      size_t nenc = 0;
+      if (i < (sizeof(zpe_tests)/sizeof(*zpe_tests))) {
+        for (const char* p = zpe_tests[i].in; *p; p += 2) {
+          in[n++] = strtol((char[]) { p[0], p[1], 0 }, NULL, 16);
+        }
+        for (const char* p = zpe_tests[i].enc; *p; p += 2) {
+          enc[nenc++] = strtol((char[]) { p[0], p[1], 0 }, NULL, 16);
+        }
+      }
+      else {
+        // Full 0xe0 block followed by nothing, 0x00, a run or a long run
+        // with a zero pair
+        const size_t extra[] = { 0, 1, 2, 33 };
+        n = 223 + extra[i - (sizeof(zpe_tests)/sizeof(*zpe_tests))];
+        for (size_t j = 0; j < n; j++) in[j] = j < 223 ? j + 1 : 0x00;
+        enc[nenc++] = 0xe0;
+        memcpy(enc + nenc, in, 223);
+        nenc += 223;
+        if (n == 223) enc[nenc++] = 0x01;
+        if (n == 224) enc[nenc++] = 0xe1;
+        if (n == 225) { enc[nenc++] = 0xe1;  enc[nenc++] = 0x01; }
+        if (n == 256) {
+          // 30 bytes then 0x00 0x00 then 1 byte
+          for (size_t j = 223; j < 253; j++) in[j] = 0x42;
+          in[255] = 0x33;
+          enc[nenc++] = 0xff;
+          memcpy(enc + nenc, in + 223, 30);
+          nenc += 30;
+          enc[nenc++] = 0x02;
+          enc[nenc++] = 0x33;
+        }
+      }
+      size_t no = cobs_zpe_enc(out, in, n);
+      ssize_t nd = no == nenc ? cobs_zpe_dec(out, enc, nenc) : -100;
+      if ((no != nenc) || (no > COBS_ZPE_ENC_SIZE(n)) || (nd != n) ||
+          (memcmp(out, in, n) != 0)) {
+        printf("zpe test case %d - failed: enc %zu (%zu) dec %zd (%zu)\n",
+            i+1, no, nenc, nd, n);
+        failed++;
+      }
+    }
+    if (failed == 0) printf("zpe test - passed\n");
+  }
+
+  {
+    // COBS/ZPE round trip, encoded and decoded inplace, and bad input
+    static uint8_t in[2000];
+    static uint8_t b[2 * COBS_ZPE_ENC_SIZE(2000)];
+    const int sparse[] = { 1, 2, 3, 16, 300 };
+    int failed = 0;
+    srand(5);
+    for (int i = 0; i < 4000; i++) {
+      size_t n = i < 500 ? i : rand() % sizeof(in);
+      fill_random(in, n, sparse[i % 5]);
+      size_t nn = COBS_ZPE_ENC_SIZE(n) - n;
+      memmove(b + nn, in, n);
+      size_t no = cobs_zpe_enc(b, b + nn, n);
+      if ((no > COBS_ZPE_ENC_SIZE(n)) || (memchr(b, 0x00, no) != NULL)) {
+        printf("zpe round trip test %d - failed: enc len %zu\n", i+1, n);
+        failed++;
+        continue;
+      }
+      size_t off = COBS_ZPE_DEC_SIZE(no) - no;
+      memmove(b + off, b, no);
+      ssize_t nd = cobs_zpe_dec(b, b + off, no);
+      if ((nd != n) || (memcmp(b, in, n) != 0)) {
+        printf("zpe round trip test %d - failed: nout (%zd) != %zu\n",
+            i+1, nd, n);
+        failed++;
+      }
+    }
+    const struct { const char* in; size_t n; ssize_t nout; } bad[] = {
+      { "\x03\x11\x00",         3, -1 },
+      { "\x03\x11",              2, -2 },
+      { "\xe0\x11",              2, -2 },
+      { "\xe3\x11\x22\x02",      4, -2 },
+    };
+    for (int i = 0; i < (sizeof(bad)/sizeof(*bad)); i++) {
+      ssize_t nd = cobs_zpe_dec(b, (const uint8_t*) bad[i].in, bad[i].n);
+      if (nd != bad[i].nout) {
+        printf("zpe bad test %d - failed: nout (%zd) != %zd\n",
+            i+1, nd, bad[i].nout);
+        failed++;
+      }
+    }
+    if (failed == 0) printf("zpe round trip test - passed\n");
+  }
+
   return 0;
 }
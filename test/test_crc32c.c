@@ -0,0 +1,198 @@
+// © 2025 Unit Circle Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cb.h"
+#include "cb_crc32c.h"
+#include "crc32c.h"
+#include "crc32c_mt.h"
+
+// Bit at a time reference
+static uint32_t ref_crc(uint32_t crc, const uint8_t* data, size_t n) {
+  crc ^= 0xffffffff;
+  while (n-- > 0) {
+    crc ^= *data++;
+    for (int i = 0; i < 8; i++) crc = (crc >> 1) ^ (0x82f63b78 & -(crc & 1));
+  }
+  return crc ^ 0xffffffff;
+}
+
+int main(void) {
+  int failed = 0;
+
+  {
+    const struct { const char* s; uint32_t crc; } vectors[] = {
+      { "",            0x00000000 },
+      { "123456789",   0xe3069283 },
+      { "hello there", 0xa580947f },
+    };
+    for (int i = 0; i < (sizeof(vectors)/sizeof(*vectors)); i++) {
+      uint32_t crc = crc32c_update(CRC32C_INIT, (const uint8_t*) vectors[i].s,
+                                   strlen(vectors[i].s));
+      if (crc != vectors[i].crc) {
+        printf("crc32c vector %d - failed: 0x%08x != 0x%08x\n",
+            i+1, crc, vectors[i].crc);
+        failed++;
+      }
+    }
+  }
+
+  {
+    // Random lengths and alignments, split in two, and with the crc
+    // appended must give CRC32C_OK_REM
+    static uint8_t data[100000 + 16];
+    srand(1);
+    for (size_t i = 0; i < sizeof(data); i++) data[i] = rand();
+    for (int i = 0; i < 3000; i++) {
+      size_t n = i < 1000 ? i : rand() % 100000;
+      if (i % 100 == 0) n = 3 * 8192 * (1 + rand() % 4) + rand() % 3;
+      size_t off = rand() % 16;
+      size_t k = n > 0 ? rand() % n : 0;
+      const uint8_t* d = data + off;
+      uint32_t ref = ref_crc(CRC32C_INIT, d, n);
+      uint32_t crc = crc32c_update(CRC32C_INIT, d, n);
+      uint32_t split = crc32c_update(crc32c_update(CRC32C_INIT, d, k), d + k, n - k);
+      const uint8_t le[4] = { crc, crc >> 8, crc >> 16, crc >> 24 };
+      uint32_t rem = crc32c_update(crc, le, 4);
+      if ((crc != ref) || (split != ref) || (rem != CRC32C_OK_REM)) {
+        printf("crc32c test %d - failed: len %zu off %zu\n", i+1, n, off);
+        failed++;
+      }
+    }
+  }
+
+  {
+    // Lengths either side of where the kernels change - the three stream
+    // crc32q loops (3 * 256 and 3 * 8192) and PCLMULQDQ folding (128)
+    static uint8_t data[4 * 8192 + 16];
+    srand(5);
+    for (size_t i = 0; i < sizeof(data); i++) data[i] = rand();
+    const size_t edges[] = { 128, 3 * 256, 2 * 3 * 256, 3 * 8192, 4 * 8192 };
+    for (int i = 0; i < (sizeof(edges)/sizeof(*edges)); i++) {
+      for (size_t n = edges[i] - 9; (n <= edges[i] + 9) && (n + 16 <= sizeof(data)); n++) {
+        size_t off = n % 16;
+        if (crc32c_update(CRC32C_INIT, data + off, n) != ref_crc(CRC32C_INIT, data + off, n)) {
+          printf("crc32c edge test - failed: len %zu off %zu\n", n, off);
+          failed++;
+        }
+      }
+    }
+  }
+
+  {
+    // Combining crcs of two parts must give the crc of the whole
+    static uint8_t data[100000];
+    srand(2);
+    for (size_t i = 0; i < sizeof(data); i++) data[i] = rand();
+    for (int i = 0; i < 2000; i++) {
+      size_t n = i < 500 ? i : rand() % sizeof(data);
+      size_t k = n > 0 ? rand() % (n + 1) : 0;
+      if (i % 7 == 0) k = n;
+      uint32_t crc = crc32c_update(CRC32C_INIT, data, n);
+      uint32_t a = crc32c_update(CRC32C_INIT, data, k);
+      uint32_t b = crc32c_update(CRC32C_INIT, data + k, n - k);
+      uint32_t op = crc32c_combine_gen(n - k);
+      if ((crc32c_combine(a, b, n - k) != crc) ||
+          (crc32c_combine_op(a, b, op) != crc)) {
+        printf("crc32c combine test %d - failed: len %zu split %zu\n", i+1, n, k);
+        failed++;
+      }
+    }
+    if (crc32c_combine_op(0x12345678, 0x9abcdef0, 0) != 0x9abcdef0) {
+      printf("crc32c combine zero op test - failed\n");
+      failed++;
+    }
+  }
+
+  {
+    // Parallel crc of a large buffer, with a crc carried in
+    static uint8_t data[8 * 1024 * 1024 + 123];
+    srand(3);
+    for (size_t i = 0; i < sizeof(data); i++) data[i] = rand();
+    const unsigned threads[] = { 0, 2, 3, 8 };
+    for (int i = 0; i < (sizeof(threads)/sizeof(*threads)); i++) {
+      uint32_t pre = crc32c_update(CRC32C_INIT, data, 100);
+      uint32_t ref = crc32c_update(pre, data + 100, sizeof(data) - 100);
+      uint32_t crc = crc32c_parallel(pre, data + 100, sizeof(data) - 100,
+                                     threads[i]);
+      if (crc != ref) {
+        printf("crc32c parallel test %d - failed: 0x%08x != 0x%08x\n",
+            i+1, crc, ref);
+        failed++;
+      }
+    }
+  }
+
+  {
+    // Copy with crc, directly and out of a circular buffer across the wrap
+    static uint8_t data[20000];
+    static uint8_t out[20000];
+    static uint8_t ring[7000];
+    srand(4);
+    for (size_t i = 0; i < sizeof(data); i++) data[i] = rand();
+    cb_t cb;
+    cb_init(&cb, ring, sizeof(ring));
+    for (int i = 0; i < 2000; i++) {
+      size_t n = i < 500 ? i : rand() % sizeof(data);
+      uint32_t ref = crc32c_update(0x12345678, data, n);
+      memset(out, 0, n);
+      uint32_t crc = crc32c_copy(out, data, n, 0x12345678);
+      if ((crc != ref) || (memcmp(out, data, n) != 0)) {
+        printf("crc32c copy test %d - failed: len %zu\n", i+1, n);
+        failed++;
+      }
+
+      n %= sizeof(ring);
+      cb_write(&cb, data, n);
+      memset(out, 0, n);
+      crc = cb_read_crc32c(&cb, out, n, CRC32C_INIT);
+      if ((crc != crc32c_update(CRC32C_INIT, data, n)) ||
+          (memcmp(out, data, n) != 0) || (cb_read_avail(&cb) != 0)) {
+        printf("cb_read_crc32c test %d - failed: len %zu\n", i+1, n);
+        failed++;
+      }
+    }
+  }
+
+  {
+    // Many packets of random length at once
+    static uint8_t data[300 * 256];
+    const uint8_t* bufs[300];
+    size_t lens[300];
+    uint32_t out[300];
+    srand(5);
+    for (size_t i = 0; i < sizeof(data); i++) data[i] = rand();
+    for (int i = 0; i < 200; i++) {
+      size_t count = rand() % 300;
+      for (size_t j = 0; j < count; j++) {
+        bufs[j] = data + 256 * j + rand() % 16;
+        lens[j] = i % 2 ? rand() % 240 : 32 + rand() % 200;
+      }
+      crc32c_multi(bufs, lens, out, count);
+      for (size_t j = 0; j < count; j++) {
+        if (out[j] != ref_crc(CRC32C_INIT, bufs[j], lens[j])) {
+          printf("crc32c multi test %d - failed: packet %zu len %zu\n",
+              i+1, j+1, lens[j]);
+          failed++;
+          break;
+        }
+      }
+    }
+  }
+
+  if (failed == 0) printf("crc32c test - passed\n");
+  return failed != 0;
+}
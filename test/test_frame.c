@@ -0,0 +1,82 @@
+// © 2025 Unit Circle Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cobs.h"
+#include "crc32c.h"
+#include "frame.h"
+
+static void fill_random(uint8_t* b, size_t n, int sparse) {
+  for (size_t j = 0; j < n; j++) {
+    b[j] = (rand() % sparse) == 0 ? 0x00 : (rand() % 255) + 1;
+  }
+}
+
+int main(void) {
+  static uint8_t data[3000];
+  static uint8_t ref[UCCOMM_FRAME_ENC_SIZE(3000)];
+  static uint8_t b[UCCOMM_FRAME_ENC_SIZE(3000)];
+  static uint8_t tmp[3004];
+  const int sparse[] = { 1, 2, 16, 300, 100000 };
+  int failed = 0;
+  srand(1);
+  for (int i = 0; i < 2000; i++) {
+    size_t n = i < 600 ? i : rand() % sizeof(data);
+    fill_random(data, n, sparse[i % 5]);
+
+    // Reference - CRC appended then COBS encoded as separate passes
+    memcpy(tmp, data, n);
+    uint32_t crc = crc32c_update(CRC32C_INIT, data, n);
+    for (int j = 0; j < 4; j++) tmp[n + j] = crc >> (8 * j);
+    size_t nref = cobs_enc(ref + 1, tmp, n + 4);
+    ref[0] = 0x00;
+    ref[nref + 1] = 0x00;
+    nref += 2;
+
+    // Encode inplace
+    size_t nn = UCCOMM_FRAME_ENC_SIZE(n);
+    memcpy(b + nn - n, data, n);
+    size_t no = uccomm_frame_encode(b, b + nn - n, n);
+    if ((no != nref) || (no > nn) || (memcmp(b, ref, nref) != 0)) {
+      printf("frame enc test %d - failed: len %zu\n", i+1, n);
+      failed++;
+      continue;
+    }
+
+    // Decode inplace, with and without delimiters
+    size_t skip = i % 3 == 0 ? 1 : 0;
+    ssize_t nd = uccomm_frame_decode(b, b + skip, no - 2 * skip);
+    if ((nd != n) || (memcmp(b, data, n) != 0)) {
+      printf("frame dec test %d - failed: nout (%zd) != %zu\n", i+1, nd, n);
+      failed++;
+      continue;
+    }
+
+    // Corrupted frame must not decode
+    ref[1 + rand() % (nref - 2)] ^= 1 << (rand() % 8);
+    nd = uccomm_frame_decode(b, ref, nref);
+    if (nd >= 0) {
+      printf("frame bad crc test %d - failed: nout (%zd)\n", i+1, nd);
+      failed++;
+    }
+  }
+  if (uccomm_frame_decode(b, (const uint8_t*) "\x00\x03\x01\x02\x00", 5) != -3) {
+    printf("frame short test - failed\n");
+    failed++;
+  }
+  if (failed == 0) printf("frame test - passed\n");
+  return failed != 0;
+}